@@ -7,10 +7,97 @@
 // Bitrate: 128 for mp3, 64 for aac (lower = less bandwidth)
 #define STREAM_FORMAT   "mp3"
 #define STREAM_BITRATE  128
+// Playlist quality picked from channels.json: "highest", "high" or "low".
+// Its .pls lists the relay servers (ice1/ice2/...) used for failover.
+#define STREAM_QUALITY  "high"
+#define STREAM_CONNECT_MS 4000  // playlist (.pls) fetch timeout
+// Total time one connect may spend walking the relay list. Each relay
+// attempt can take up to 5 s (HTTPClient default) when a host hangs.
+#define STREAM_BUDGET_MS  10000
+// Reconnect backoff: doubles per consecutive failure up to the max (±25% jitter)
+#define RECONNECT_BASE_MS 500
+#define RECONNECT_MAX_MS  30000
+
+// WiFi fast reconnect: the last AP's BSSID and channel are remembered and
+// tried directly first; after WIFI_FAST_MS without a link a full scan runs.
+// WIFI_REUSE_IP 1 also reuses the last DHCP lease as a static config
+// (skips DHCP; only safe where the router keeps leases stable).
+#define WIFI_FAST_MS    3000
+#define WIFI_REUSE_IP   0
+// Roaming: while streaming below this RSSI (dBm), scan for a saved
+// network's AP that is at least 8 dB stronger and move to it.
+// -100 effectively disables.
+#define WIFI_ROAM_RSSI  -72
 
 // ──────────────────────────────────────────────────────────
 // Player Settings
 // ──────────────────────────────────────────────────────────
 #define DEFAULT_VOLUME  100     // 0-255
 #define MAX_STATIONS    50
-#define AUDIO_BUF_SIZE  8192    // HTTP stream buffer (bytes)
+#define AUDIO_BUF_SIZE  24576   // HTTP stream buffer (bytes)
+// Smallest stream buffer used whatever AUDIO_BUF_SIZE says (when the heap
+// allows), so an older config.h with 8 KB still gets the larger buffer.
+#define STREAM_BUF_MIN  24576
+// The screen is drawn in bands of UI_BAND_H rows into two buffers of
+// 240 x UI_BAND_H x 2 bytes instead of one 63 KB framebuffer. Smaller
+// bands save RAM but run the draw code more often per frame (135 / h).
+#define UI_BAND_H       27
+// Frames are drawn only when something changes or animates; the
+// visualizer requests UI_VIS_FPS (30-60), scrolling text ~25 fps.
+#define UI_VIS_FPS      30
+// Logo thumbnails in the browser rows, from an atlas file that a
+// background task builds out of the logo cache (logos are cached when a
+// station is played).
+#define BROWSER_THUMBS  true
+// Auto-play the last station on boot ('a' in the browser toggles it; this
+// is the default before it has been toggled). The stream is connected as
+// soon as WiFi is up, in parallel with loading the channel list.
+#define AUTOPLAY_DEFAULT false
+// CPU clock while only streaming (screen dimmed, visualizer off); input,
+// crossfades or a decoder falling behind restore full speed. 80 or 160;
+// check the miss= count in the [AUDIO] log. 0 keeps the clock fixed.
+#define CPU_IDLE_MHZ    160
+// Burst mode: use a larger stream buffer, fill it at full speed, then let
+// the WiFi radio modem-sleep until it drains to a third (~1.3 s of radio
+// sleep per burst at 128 kbps with 32 KB). Falls back to AUDIO_BUF_SIZE
+// when free heap would drop below BURST_MIN_HEAP or warm standby is on.
+// 0 disables.
+#define BURST_BUF_KB    32
+#define BURST_MIN_HEAP  40000
+// While paused the decoder stops and the stream is held open (TCP
+// backpressure) for this long, then dropped; resume reconnects.
+// 0 = drop the stream as soon as playback is paused.
+#define PAUSE_HOLD_MS   30000
+// Time-shift: while paused, keep recording the stream into a ring file
+// and resume from the pause point (about 16 KB per second at 128 kbps).
+// The SD card is used when present, otherwise LittleFS. 0 disables.
+#define TIMESHIFT_KB    512     // LittleFS ring size
+#define TIMESHIFT_SD_KB 8192    // microSD ring size
+// Catch-up after a time-shifted resume: playback runs this many percent
+// fast (slightly higher pitch) and skips quiet passages until it is back
+// at live; a 60 s pause takes about 30 min at 3. 0 = stay delayed ('l').
+#define TS_CATCHUP_PCT  3
+// Recording to microSD ('r' in Now Playing): the stream is copied into
+// blocks that a writer task flushes; more blocks ride out slower cards.
+#define REC_BLOCK_SIZE  4096    // bytes, multiple of 512
+#define REC_BLOCKS      6
+// Crossfade on station switch: the old station keeps playing until the new
+// one is connected, then fades out over XFADE_MS (300-500 works well).
+// Needs a second MP3 decoder (~50 KB); skipped below XFADE_MIN_HEAP.
+// 0 disables.
+#define XFADE_MS        0
+#define XFADE_MIN_HEAP  80000
+// A/B toggle ('b' in Now Playing): the previous station's connection is
+// kept open but unread, so TCP backpressure stops it using bandwidth.
+// Released after AB_HOLD_MS or when free heap drops below AB_MIN_HEAP.
+// 0 disables.
+#define AB_HOLD_MS      120000
+#define AB_MIN_HEAP     50000
+// Warm standby ('w' in Now Playing): the next/previous stations are kept
+// connected with a small prefill so skipping starts at once. Costs about
+// WARM_PREFILL + 12 KB heap per slot; a full slot is left unread (TCP
+// backpressure) and reconnected every 30 s. Slots are closed when free
+// heap drops below WARM_MIN_HEAP. 0 disables.
+#define WARM_SLOTS      2
+#define WARM_PREFILL    4096    // bytes per slot (~0.25 s at 128 kbps)
+#define WARM_MIN_HEAP   60000
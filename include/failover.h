@@ -0,0 +1,38 @@
+#pragma once
+// Stream server ranking and the budgeted failover walk used by
+// connectStream(). Free of Arduino types so test/host can build it.
+#include <stdint.h>
+
+// Connect history of one relay host: smoothed time-to-first-byte and the
+// current failure streak. Lower score() is tried first.
+struct HostRank {
+    uint32_t ttfbMs = 500;   // neutral prior for an unmeasured host
+    uint8_t  fails  = 0;     // consecutive failures
+
+    uint32_t score() const { return ttfbMs + fails * 3000; }
+
+    void note(bool ok, uint32_t ms) {
+        if (ok) {
+            ttfbMs = (ttfbMs * 3 + ms) / 4;
+            fails  = 0;
+        } else if (fails < 10) {
+            fails++;
+        }
+    }
+};
+
+// Try candidates 0..n-1 in order until open(i) succeeds; returns its index
+// or -1. A further attempt starts only while a whole attemptMs still fits
+// in budgetMs, so a list of hung relays costs at most budgetMs (the first
+// attempt always runs). stop() is polled before each attempt.
+template <typename Now, typename Open, typename Stop>
+int openWithinBudget(int n, uint32_t attemptMs, uint32_t budgetMs,
+                     Now now, Open open, Stop stop) {
+    uint32_t t0 = now();
+    for (int i = 0; i < n; i++) {
+        if (stop()) break;
+        if (i > 0 && (uint32_t)(now() - t0) + attemptMs > budgetMs) break;
+        if (open(i)) return i;
+    }
+    return -1;
+}
@@ -0,0 +1,48 @@
+#pragma once
+// Recording tee: copies stream bytes into fixed-size blocks for a writer
+// task. Free of Arduino types so test/host can build it.
+#include <stdint.h>
+#include <string.h>
+
+// take() hands out an empty block (nullptr when none is free) and give()
+// queues a filled one (false when the writer's queue is full). Neither may
+// wait, so a slow card costs dropped bytes, counted, never a stalled feed.
+struct BlockTee {
+    typedef uint8_t *(*TakeFn)();
+    typedef bool     (*GiveFn)(uint8_t *blk, uint32_t len);
+
+    uint32_t  block;
+    TakeFn    take;
+    GiveFn    give;
+    uint8_t  *cur = nullptr;   // block being filled
+    uint32_t  len = 0;
+    volatile uint32_t dropped = 0;
+
+    BlockTee(uint32_t blockLen, TakeFn t, GiveFn g) : block(blockLen), take(t), give(g) {}
+
+    void reset() { cur = nullptr; len = 0; dropped = 0; }
+
+    // Queue the current block; if the queue is full its bytes are dropped
+    // and the block is kept for reuse
+    void flush() {
+        if (!cur || len == 0) return;
+        if (give(cur, len)) cur = nullptr;
+        else dropped += len;
+        len = 0;
+    }
+
+    void feed(const uint8_t *d, uint32_t n) {
+        while (n > 0) {
+            if (!cur && !(cur = take())) {
+                dropped += n;
+                return;
+            }
+            uint32_t k = n < block - len ? n : block - len;
+            memcpy(cur + len, d, k);
+            len += k;
+            d   += k;
+            n   -= k;
+            if (len == block) flush();
+        }
+    }
+};
@@ -0,0 +1,37 @@
+#pragma once
+// Truncation core of fitText(): prefix widths from a per-font advance
+// table and the search for the longest prefix that fits. Free of Arduino
+// types so test/host can build it.
+#include <stdint.h>
+
+// FNV-1a over the bytes of s, the fitText() memo key
+static inline uint32_t textHash(const char *s, int n) {
+    uint32_t h = 2166136261u;
+    for (int i = 0; i < n; i++) h = (h ^ (uint8_t)s[i]) * 16777619u;
+    return h;
+}
+
+// pre[i] = width of the first i bytes, from adv[] (advances of ' '..'~').
+// False when a byte is outside that range; pre[] is then incomplete.
+static inline bool prefixWidths(const char *s, int n, const uint8_t *adv, uint16_t *pre) {
+    pre[0] = 0;
+    for (int i = 0; i < n; i++) {
+        uint8_t ch = s[i];
+        if (ch < 32 || ch > 126) return false;
+        pre[i + 1] = pre[i] + adv[ch - 32];
+    }
+    return true;
+}
+
+// Longest len in 0..n-1 with width(len) + tailPx <= maxPx, for a width()
+// that grows with len; O(log n) calls
+template <typename W>
+int fitPrefixLen(int n, int maxPx, int tailPx, W width) {
+    int lo = 0, hi = n - 1;
+    while (lo < hi) {
+        int mid = (lo + hi + 1) / 2;
+        if (width(mid) + tailPx <= maxPx) lo = mid;
+        else hi = mid - 1;
+    }
+    return lo;
+}
@@ -0,0 +1,104 @@
+#pragma once
+// Byte FIFOs and the time-shift ring file used by tsTask. Free of Arduino
+// types so test/host can build it; F is any file type with
+// seek(pos), read(buf, n) and write(buf, n) (fs::File on the device).
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+static inline uint32_t u32min(uint32_t a, uint32_t b) { return a < b ? a : b; }
+
+// Lock-free byte FIFO: exactly one producer task and one consumer task
+struct ByteFifo {
+    uint8_t *buf  = nullptr;
+    uint32_t size = 0;
+    volatile uint32_t head = 0;  // total bytes pushed
+    volatile uint32_t tail = 0;  // total bytes popped
+
+    bool alloc(uint32_t n) {
+        buf  = (uint8_t *)malloc(n);
+        size = buf ? n : 0;
+        head = tail = 0;
+        return buf != nullptr;
+    }
+    void release() { free(buf); buf = nullptr; size = 0; head = tail = 0; }
+    uint32_t used()  const { return head - tail; }
+    uint32_t space() const { return size - used(); }
+
+    uint32_t push(const uint8_t *d, uint32_t n) {
+        n = u32min(n, space());
+        uint32_t pos   = head % size;
+        uint32_t first = u32min(n, size - pos);
+        memcpy(buf + pos, d, first);
+        memcpy(buf, d + first, n - first);
+        head += n;
+        return n;
+    }
+    uint32_t peek(uint8_t *d, uint32_t n) const {  // consumer side: copy, keep
+        n = u32min(n, used());
+        uint32_t pos   = tail % size;
+        uint32_t first = u32min(n, size - pos);
+        memcpy(d, buf + pos, first);
+        memcpy(d + first, buf, n - first);
+        return n;
+    }
+    uint32_t pop(uint8_t *d, uint32_t n) {
+        n = peek(d, n);
+        tail += n;
+        return n;
+    }
+    uint32_t drop(uint32_t n) {  // consumer side: discard without copying
+        n = u32min(n, used());
+        tail += n;
+        return n;
+    }
+};
+
+// Ring of cap bytes in a file, filled from one FIFO in whole chunks and
+// drained into another. wr/rd count bytes ever written/read; when the
+// ring is full the oldest audio is dropped.
+template <typename F>
+struct TsRing {
+    F       *f   = nullptr;
+    uint32_t cap = 0, wr = 0, rd = 0;
+
+    void reset(F *file, uint32_t bytes) { f = file; cap = bytes; wr = rd = 0; }
+    uint32_t stored() const { return wr - rd; }
+
+    // One chunk from in into the file; 0 while in holds less than a chunk
+    uint32_t store(ByteFifo &in, uint8_t *chunk, uint32_t chunkLen) {
+        if (in.used() < chunkLen) return 0;
+        uint32_t n     = in.pop(chunk, chunkLen);
+        uint32_t pos   = wr % cap;
+        uint32_t first = u32min(n, cap - pos);
+        f->seek(pos);
+        f->write(chunk, first);
+        if (n > first) { f->seek(0); f->write(chunk + first, n - first); }
+        wr += n;
+        if (wr - rd > cap) rd = wr - cap;  // ring full: drop the oldest audio
+        return n;
+    }
+
+    // Up to one chunk from the file into out; 0 when empty or out is full
+    uint32_t load(ByteFifo &out, uint8_t *chunk, uint32_t chunkLen) {
+        if (wr == rd || out.space() < chunkLen) return 0;
+        uint32_t n     = u32min(chunkLen, wr - rd);
+        uint32_t pos   = rd % cap;
+        uint32_t first = u32min(n, cap - pos);
+        f->seek(pos);
+        f->read(chunk, first);
+        if (n > first) { f->seek(0); f->read(chunk + first, n - first); }
+        out.push(chunk, n);
+        rd += n;
+        return n;
+    }
+};
+
+// Caught up (ring empty): move in straight to out. Bytes leave in only
+// after they are in out, so both FIFOs empty means nothing is in flight.
+static inline uint32_t fifoPass(ByteFifo &in, ByteFifo &out, uint8_t *chunk, uint32_t chunkLen) {
+    uint32_t n = in.peek(chunk, u32min(chunkLen, out.space()));
+    out.push(chunk, n);
+    in.drop(n);
+    return n;
+}
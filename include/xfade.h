@@ -0,0 +1,51 @@
+#pragma once
+// Crossfade mixing used by DirectI2SOutput / MixVoice. Free of Arduino
+// types so test/host can build it.
+#include <stdint.h>
+#include <stdlib.h>
+
+// Mono samples from the outgoing decoder, consumed by the mixer. Both
+// ends run on the audio task, so no locking.
+template <uint32_t N>
+struct MonoRing {
+    int16_t *buf  = nullptr;
+    uint32_t head = 0, tail = 0;
+
+    bool alloc() {   // kept across fades once allocated
+        if (!buf) buf = (int16_t *)malloc(N * sizeof(int16_t));
+        head = tail = 0;
+        return buf != nullptr;
+    }
+    void clear() { head = tail = 0; }
+    bool push(int16_t s) {
+        if (!buf || head - tail >= N) return false;
+        buf[head++ % N] = s;
+        return true;
+    }
+    bool pop(int16_t &s) {
+        if (head == tail) return false;
+        s = buf[tail++ % N];
+        return true;
+    }
+};
+
+// Q15 linear ramp: the incoming sample rises from 0 to full over len
+// samples while the outgoing one falls
+struct FadeRamp {
+    uint32_t pos = 0, len = 1, gain = 0, step = 0;
+
+    void start(uint32_t n) {
+        pos  = 0;
+        len  = n ? n : 1;
+        gain = 0;
+        step = (32767u << 16) / len;
+    }
+    bool done() const { return pos >= len; }
+
+    int16_t mix(int16_t in, int16_t old) {
+        int32_t g = gain >> 16;
+        gain += step;
+        pos++;
+        return (int16_t)(((int32_t)in * g + (int32_t)old * (32767 - g)) >> 15);
+    }
+};
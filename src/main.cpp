@@ -20,13 +20,113 @@
 #include <WiFiClientSecure.h>
 #include <ArduinoJson.h>
 #include <AudioFileSourceHTTPStream.h>
+#include <AudioFileSourceICYStream.h>
 #include <AudioFileSourceBuffer.h>
 #include <AudioGeneratorMP3.h>
 #include <AudioOutput.h>
 #include <algorithm>
 #include <Preferences.h>
 #include <LittleFS.h>
+#include <SD.h>
+#include <SPI.h>
+#include <esp_heap_caps.h>
+#include <esp_wifi.h>
 #include "config.h"
+#include "failover.h"
+#include "xfade.h"
+#include "timeshift.h"
+#include "recblocks.h"
+#include "textfit.h"
+
+// Defaults for settings added after config.example.h was first published,
+// so an existing include/config.h keeps building.
+#ifndef PAUSE_HOLD_MS
+#define PAUSE_HOLD_MS   30000
+#endif
+#ifndef TIMESHIFT_KB
+#define TIMESHIFT_KB    512
+#endif
+#ifndef TIMESHIFT_SD_KB
+#define TIMESHIFT_SD_KB 8192
+#endif
+#ifndef TS_CATCHUP_PCT
+#define TS_CATCHUP_PCT  3
+#endif
+#ifndef STREAM_QUALITY
+#define STREAM_QUALITY  "high"
+#endif
+#ifndef STREAM_CONNECT_MS
+#define STREAM_CONNECT_MS 4000
+#endif
+#ifndef STREAM_BUDGET_MS
+#define STREAM_BUDGET_MS  10000
+#endif
+#ifndef RECONNECT_BASE_MS
+#define RECONNECT_BASE_MS 500
+#endif
+#ifndef RECONNECT_MAX_MS
+#define RECONNECT_MAX_MS  30000
+#endif
+#ifndef REC_BLOCK_SIZE
+#define REC_BLOCK_SIZE  4096
+#endif
+#ifndef REC_BLOCKS
+#define REC_BLOCKS      6
+#endif
+#ifndef AB_HOLD_MS
+#define AB_HOLD_MS      120000
+#endif
+#ifndef AB_MIN_HEAP
+#define AB_MIN_HEAP     50000
+#endif
+#ifndef XFADE_MS
+#define XFADE_MS        0
+#endif
+#ifndef XFADE_MIN_HEAP
+#define XFADE_MIN_HEAP  80000
+#endif
+#ifndef WIFI_FAST_MS
+#define WIFI_FAST_MS    3000
+#endif
+#ifndef WIFI_REUSE_IP
+#define WIFI_REUSE_IP   0
+#endif
+#ifndef WIFI_ROAM_RSSI
+#define WIFI_ROAM_RSSI  -72
+#endif
+#ifndef UI_BAND_H
+#define UI_BAND_H       27
+#endif
+#ifndef STREAM_BUF_MIN
+#define STREAM_BUF_MIN  24576
+#endif
+#ifndef UI_VIS_FPS
+#define UI_VIS_FPS      30
+#endif
+#ifndef BROWSER_THUMBS
+#define BROWSER_THUMBS  true
+#endif
+#ifndef AUTOPLAY_DEFAULT
+#define AUTOPLAY_DEFAULT false
+#endif
+#ifndef CPU_IDLE_MHZ
+#define CPU_IDLE_MHZ    0
+#endif
+#ifndef BURST_BUF_KB
+#define BURST_BUF_KB    0
+#endif
+#ifndef BURST_MIN_HEAP
+#define BURST_MIN_HEAP  40000
+#endif
+#ifndef WARM_SLOTS
+#define WARM_SLOTS      2
+#endif
+#ifndef WARM_PREFILL
+#define WARM_PREFILL    4096
+#endif
+#ifndef WARM_MIN_HEAP
+#define WARM_MIN_HEAP   60000
+#endif
 
 // ═══════════════════════════════════════════════════════════
 //  COLOR PALETTE (RGB565)
@@ -76,15 +176,19 @@ struct Station {
     String desc;
     String genre;
     String imageUrl;
+    String plsUrl;       // playlist (.pls) for STREAM_FORMAT / STREAM_QUALITY
     uint16_t color;
     int listeners;
     bool fav;
+    uint32_t rowKey;     // new value whenever its browser row looks different
+    int16_t thumb;       // atlas slot, -1 none, -2 not looked up
 };
 
 enum AppState {
     STATE_BOOT,
     STATE_WIFI_SCAN,
     STATE_WIFI_PASS,
+    STATE_WIFI_CONNECT,
     STATE_BROWSER,
     STATE_PLAYING,
     STATE_ERROR
@@ -99,6 +203,7 @@ enum AppState {
 //  GLOBALS
 // ═══════════════════════════════════════════════════════════
 Station   stations[MAX_STATIONS];
+uint32_t  rowKeyNext    = 0;
 int       stationCount  = 0;
 int       selectedIdx   = 0;
 int       scrollOffset  = 0;
@@ -113,32 +218,54 @@ M5Canvas  canvas(&M5.Display);
 
 // Audio pipeline  (Direct I2S → ES8311 codec)
 AudioOutput                  *audioOut    = nullptr;
-AudioFileSourceHTTPStream    *audioSrc    = nullptr;
+AudioFileSourceICYStream     *audioSrc    = nullptr;
 AudioFileSourceBuffer        *audioBuf    = nullptr;
 AudioGeneratorMP3            *mp3         = nullptr;
+class AudioFileSourceTimeShift;
+AudioFileSourceTimeShift     *audioShift  = nullptr;  // between audioTee and audioBuf
+class AudioFileSourceTee;
+AudioFileSourceTee           *audioTee    = nullptr;  // recording tap on audioLink
+class AudioFileSourceLink;
+AudioFileSourceLink          *audioLink   = nullptr;  // swappable holder of audioSrc
 
 // Audio task
 TaskHandle_t  audioTaskH  = nullptr;
+volatile bool aHwReady    = false;  // I2S + codec initialised by the audio task
 volatile bool aRunning    = false;
 volatile bool aPaused     = false;
 volatile int  aCmd        = ACMD_NONE;
 volatile int  aTarget     = -1;
 
+// Decoder load accounting (busy time on Core 0 over a 10 s window)
+volatile uint8_t aCpuLoad   = 0;   // percent, excludes time blocked in i2s_write
+volatile uint32_t aI2sWaitUs = 0;  // accumulated by DirectI2SOutput
+volatile uint32_t aBufFill   = 0;  // stream buffer fill (bytes), for Core 1
+volatile bool     aLinkUp    = false; // playing stream attached to its socket
+volatile uint32_t aDecodeMiss = 0; // DMA ran dry while the decoder was due
+volatile uint32_t aBoostUntil = 0; // millis() until which the audio task wants full clock
+
 // Timing
-unsigned long tLastUI     = 0;
 unsigned long tLastNP     = 0;
 unsigned long tLastKey    = 0;
 unsigned long tLastInput  = 0;   // last user interaction (for screen dim)
 const unsigned long DEBOUNCE_MS   = 180;
 const unsigned long REPEAT_INIT   = 400;  // ms before auto-repeat starts
 const unsigned long REPEAT_MS     = 80;   // ms between repeats
-const unsigned long UI_MS         = 66;
+const unsigned long UI_SCROLL_MS  = 40;   // frame interval while a text scrolls
+const unsigned long UI_BLINK_MS   = 500;  // cursor blink / progress dots
+const unsigned long UI_EQ_MS      = 66;   // header mini EQ (visualizer: UI_VIS_FPS)
+const unsigned long UI_POLL_MS    = 10;   // loop() sleep while no frame is due
 const unsigned long NP_MS         = 30000;
 const unsigned long DIM_TIMEOUT   = 15000; // dim screen after 15s idle
 const uint8_t BRIGHTNESS_NORMAL   = 80;
 const uint8_t BRIGHTNESS_DIM      = 10;
 bool screenDimmed = false;
 
+// Battery (published by battService(); nothing else reads the PMIC/ADC)
+int  battLevel    = -1;   // percent, filtered; -1 until the first sample
+bool battCharging = false;
+int  battMinsLeft = -1;   // runtime estimate from the discharge slope, -1 unknown
+
 // Audio visualizer
 #define VIS_OFF   0
 #define VIS_BARS  1
@@ -163,17 +290,47 @@ static uint32_t _peakAcc = 0;
 static int      _peakCnt = 0;
 static int      _waveSub = 0;
 
+// Optional microSD card (time-shift ring, recordings)
+SPIClass sdSPI(HSPI);
+volatile bool sdMounted = false;   // set by sdMountTask once the card is up
+
+// ICY in-stream metadata (written on Core 0, read on Core 1)
+portMUX_TYPE  icyMux       = portMUX_INITIALIZER_UNLOCKED;
+char          icyTitle[96] = "";
+volatile uint32_t icySeq   = 0;
+volatile bool icyActive    = false;   // current stream carries StreamTitle
+
+// Warm standby of the neighbour stations ('w' in Now Playing)
+volatile bool warmOn = false;
+
+// A/B toggle ('b' in Now Playing): station played before the current one
+String prevStationId = "";
+
+// Auto-play on boot ('a' in the browser): the audio task connects the last
+// station from NVS as soon as WiFi is up; Core 1 maps it into the list later.
+// Retries after a failed connect or a dead stream go through the same
+// pending play, by station id, so they never depend on the list index.
+bool   autoPlay    = false;
+String pendPlayId  = "", pendPlayPls = "";   // audio task, until a connect succeeds
+volatile bool bootPlaying = false;           // auto-play stream is up (for Core 1)
+String autoPlayId  = "";                     // Core 1
+
 // Logo cache
 uint8_t *logoData    = nullptr;
 size_t   logoDataLen = 0;
 int      logoForIdx  = -1;
 bool     logoValid   = false;
+M5Canvas logoLayer;              // decoded logo, so bands don't re-decode it
+int      logoLayerFor = -1;      // station whose logo logoLayer holds
 
 // Scroll state for car-radio text effect
 struct ScrollState {
-    String text;
-    int    fullWidth;
+    String        text;
+    int           fullWidth;
     unsigned long startMs;
+    const void   *font  = nullptr;   // font and colour the width/strip were made with
+    uint16_t      color = 0;
+    M5Canvas      strip;             // 1-bit pre-rendered text + gap (scrolling only)
 };
 ScrollState scrTitle, scrGenre, scrSong;
 
@@ -192,6 +349,65 @@ String      wifiInputSSID   = "";
 String      wifiInputPass   = "";
 String      wifiError       = "";
 unsigned long wifiErrorTime = 0;
+int         scanChannel     = 0;   // channel being scanned, 0 = idle
+unsigned long scanStartMs   = 0;
+
+// Event-driven connect (STATE_WIFI_CONNECT)
+volatile bool    wifiGotIP      = false;
+volatile uint8_t wifiDiscReason = 0;   // last STA_DISCONNECTED reason
+String        wifiConnSSID    = "";
+String        wifiConnPass    = "";
+bool          wifiConnSave    = false;          // entered by the user: store on success
+AppState      wifiConnOk      = STATE_BOOT;     // screen after connecting
+AppState      wifiConnPrev    = STATE_WIFI_SCAN; // screen to return to on cancel
+unsigned long wifiConnStart   = 0;
+int           wifiPendingPlay = -1;             // station to start once connected
+
+// Fast reconnect: last AP (BSSID + channel) and lease that worked, in NVS
+struct WifiFastCache {
+    String   ssid;
+    uint8_t  bssid[6];
+    uint8_t  chan;
+    uint32_t ip, gw, mask, dns;
+};
+WifiFastCache wifiFast    = {};
+bool          wifiFastTry = false;   // current attempt skips the scan
+bool          wifiStaticIp = false;  // lease applied with WiFi.config()
+String        wifiBeginSSID = "", wifiBeginPass = "";
+unsigned long wifiBeginMs = 0;       // 0 = no attempt being timed
+bool          wifiRoamJoin = false;  // current attempt is a roam
+
+// Saved networks, most recently used first (NVS "nets", "s<i>", "p<i>")
+#define WIFI_MAX_SAVED 6
+struct SavedNet {
+    String ssid;
+    String pass;
+};
+SavedNet savedNets[WIFI_MAX_SAVED];
+int      savedNetCount = -1;   // -1 = not loaded yet
+
+// Auto-select: last-used network first, then the others ranked by RSSI
+int  wifiAutoOrder[WIFI_MAX_SAVED];
+int  wifiAutoCount  = 0, wifiAutoNext = 0;
+bool wifiAutoRanked = false;   // ranking scan done (or not needed)
+bool wifiAutoScan   = false;   // ranking scan running
+
+// Boot timing (ms since reset): setup → WiFi → first audio
+uint32_t          tSetup = 0, tWifiUp = 0, tFirstPlay = 0;
+volatile uint32_t tFirstAudio = 0;   // set by the first I2S write
+
+// Boot profile: named phase marks from any task, printed at first audio
+#define BOOT_MARKS 16
+struct BootMark { const char *name; uint32_t ms; };
+BootMark          bootMarks[BOOT_MARKS];
+volatile uint32_t bootMarkN = 0;
+portMUX_TYPE      bootMux   = portMUX_INITIALIZER_UNLOCKED;
+
+void bootMark(const char *name) {
+    portENTER_CRITICAL(&bootMux);
+    if (bootMarkN < BOOT_MARKS) bootMarks[bootMarkN++] = {name, (uint32_t)millis()};
+    portEXIT_CRITICAL(&bootMux);
+}
 
 // ═══════════════════════════════════════════════════════════
 //  UTILITY FUNCTIONS
@@ -234,42 +450,442 @@ uint16_t blendRGB(uint16_t c1, uint16_t c2, uint8_t t) {
             (b1 + ((b2 - b1) * t >> 8));
 }
 
+// ── Layer cache ──
+// Static parts of a frame are rendered once and reused until what they
+// depend on changes: gradients as per-scanline colour tables (keyed by
+// colours and blend range), the footer hint bar as a sprite (keyed by
+// screen).
+#define GRAD_MAX_H 24
+
+struct GradLines {
+    uint16_t c1 = 0, c2 = 0;
+    uint8_t  h = 0, t0 = 0, t1 = 0;   // h = 0: empty
+    uint16_t line[GRAD_MAX_H];
+};
+GradLines hdrGrad;        // header background
+GradLines rowGrad[4];     // selected-row highlight, one per recent genre colour
+int       rowGradNext = 0;
+
+// Scanline i blends c1 → c2 by t0 + i * (t1 - t0) / h
+const uint16_t *gradLines(GradLines &g, uint16_t c1, uint16_t c2, int h, int t0, int t1) {
+    h = min(h, GRAD_MAX_H);
+    if (g.h != h || g.c1 != c1 || g.c2 != c2 || g.t0 != t0 || g.t1 != t1) {
+        for (int i = 0; i < h; i++) g.line[i] = blendRGB(c1, c2, t0 + i * (t1 - t0) / h);
+        g.c1 = c1; g.c2 = c2; g.h = h; g.t0 = t0; g.t1 = t1;
+    }
+    return g.line;
+}
+
 void drawGradient(M5Canvas &c, int y, int h, uint16_t c1, uint16_t c2) {
-    for (int i = 0; i < h; i++)
-        c.drawFastHLine(0, y + i, SCREEN_W, blendRGB(c1, c2, i * 255 / h));
+    const uint16_t *line = gradLines(hdrGrad, c1, c2, h, 0, 255);
+    for (int i = 0; i < min(h, GRAD_MAX_H); i++)
+        c.drawFastHLine(0, y + i, SCREEN_W, line[i]);
+}
+
+void drawRowGradient(M5Canvas &c, int y, uint16_t color) {
+    GradLines *g = nullptr;
+    for (auto &r : rowGrad)
+        if (r.h && r.c1 == color) g = &r;
+    if (!g) {
+        g = &rowGrad[rowGradNext];
+        rowGradNext = (rowGradNext + 1) % 4;
+    }
+    const uint16_t *line = gradLines(*g, color, C_BG, LINE_H, 55, 255);
+    for (int j = 0; j < LINE_H; j++)
+        c.drawFastHLine(0, y + j, SCREEN_W, line[j]);
+}
+
+// Per-layer draw time, averaged over UI_PROF_MS and logged as [UI]
+#define UI_PROF_MS 10000
+enum UiLayer { LAYER_HEADER, LAYER_BODY, LAYER_FOOTER, LAYER_PUSH, LAYER_WAIT, LAYER_COUNT };
+const char *const uiLayerName[LAYER_COUNT] = {"header", "body", "footer", "push", "dma-wait"};
+uint32_t      uiLayerUs[LAYER_COUNT];
+uint32_t      uiFrames   = 0;
+unsigned long uiProfFrom = 0;
+// Input-poll jitter: gap between consecutive loop() passes
+uint32_t      uiPollMaxUs = 0, uiPollSumUs = 0, uiPollN = 0, uiPollLast = 0;
+
+void uiPollTick() {
+    uint32_t t = micros();
+    if (uiPollLast) {
+        uint32_t gap = t - uiPollLast;
+        uiPollMaxUs = max(uiPollMaxUs, gap);
+        uiPollSumUs += gap;
+        uiPollN++;
+    }
+    uiPollLast = t;
+}
+
+// Charge the time since t0 to a layer; returns now for the next lap
+uint32_t uiLap(int layer, uint32_t t0) {
+    uint32_t t = micros();
+    uiLayerUs[layer] += t - t0;
+    return t;
+}
+
+void uiProfReport() {
+    if (millis() - uiProfFrom < UI_PROF_MS) return;
+    if (uiFrames) {
+        char line[96];
+        int n = snprintf(line, sizeof(line), "[UI] %u frames, us/frame:", uiFrames);
+        for (int i = 0; i < LAYER_COUNT && n < (int)sizeof(line); i++)
+            n += snprintf(line + n, sizeof(line) - n, " %s %u", uiLayerName[i],
+                          uiLayerUs[i] / uiFrames);
+        Serial.println(line);
+    }
+    if (uiPollN)
+        Serial.printf("[UI] input poll gap avg %u / max %u us\n", uiPollSumUs / uiPollN,
+                      uiPollMaxUs);
+    memset(uiLayerUs, 0, sizeof(uiLayerUs));
+    uiFrames    = 0;
+    uiPollMaxUs = uiPollSumUs = uiPollN = 0;
+    uiProfFrom  = millis();
+}
+
+// ── Frame scheduler ──
+// Nothing is redrawn on a timer. A change (key, state, new data) calls
+// uiInvalidate() for a frame as soon as possible; an animation asks for
+// its next step with uiFrameIn() while it is being drawn, so a static
+// screen draws no frames at all. While the screen is dimmed animations
+// stop asking; only changes redraw it.
+bool          uiDue     = true;    // a frame has been requested...
+unsigned long uiDueAt   = 0;       // ...for this millis()
+uint32_t      uiFpm     = 0;       // frames drawn in the last full minute
+uint32_t      uiFpmN    = 0;
+unsigned long uiFpmFrom = 0;
+
+void uiInvalidate() {
+    uiDue   = true;
+    uiDueAt = millis();
+}
+
+void uiFrameIn(unsigned long ms) {
+    if (screenDimmed) return;
+    unsigned long at = millis() + ms;
+    if (!uiDue || (long)(at - uiDueAt) < 0) {
+        uiDue   = true;
+        uiDueAt = at;
+    }
+}
+
+// Take the pending request if it is due; scenes may request the next one
+bool uiFrameDue() {
+    if (!uiDue || (long)(millis() - uiDueAt) < 0) return false;
+    uiDue = false;
+    return true;
+}
+
+void uiFpmService() {
+    if (millis() - uiFpmFrom < 60000) return;
+    uiFpm     = uiFpmN;
+    uiFpmN    = 0;
+    uiFpmFrom = millis();
+    Serial.printf("[UI] %u frames/min\n", uiFpm);
+}
+
+// ── Debug overlay (Ctrl+D) and timing histograms ──
+// Per-frame draw times, FPS and key-to-pixel latency: from the keyboard
+// change seen in loop() to the last band's DMA transfer completing. The
+// serial command "hist" dumps the histograms, "hist reset" clears them.
+enum { HIST_FRAME = LAYER_COUNT, HIST_KEY, HIST_COUNT };
+const char *const histName[HIST_COUNT] = {"header", "body", "footer", "push",
+                                          "dma-wait", "frame", "key"};
+#define HIST_BUCKETS 10   // < 0.5, 1, 2, 4 ... 128 ms, more
+struct TimeHist {
+    uint32_t n[HIST_BUCKETS];
+    uint32_t count, maxUs;
+    uint64_t sumUs;
+};
+TimeHist uiHist[HIST_COUNT];
+bool     uiDebug    = false;
+bool     uiKeyWait  = false;   // a key press is waiting for its frame
+uint32_t uiKeyUs    = 0;       // micros() of that key press
+uint32_t uiLastUs[HIST_COUNT]; // last frame's values, for the overlay
+uint32_t uiFps      = 0;
+uint32_t uiFpsN     = 0;
+unsigned long uiFpsFrom = 0;
+
+void histAdd(int which, uint32_t us) {
+    TimeHist &h = uiHist[which];
+    int b = 0;
+    for (uint32_t lim = 500; b < HIST_BUCKETS - 1 && us >= lim; b++, lim <<= 1) {}
+    h.n[b]++;
+    h.count++;
+    h.sumUs += us;
+    h.maxUs = max(h.maxUs, us);
+    uiLastUs[which] = us;
+}
+
+void histDump() {
+    Serial.println("[HIST] ms:        <.5    <1    <2    <4    <8   <16   <32   <64  <128  more    avg    max");
+    for (int i = 0; i < HIST_COUNT; i++) {
+        const TimeHist &h = uiHist[i];
+        char line[128];
+        int n = snprintf(line, sizeof(line), "[HIST] %-8s", histName[i]);
+        for (int b = 0; b < HIST_BUCKETS; b++)
+            n += snprintf(line + n, sizeof(line) - n, " %5u", h.n[b]);
+        snprintf(line + n, sizeof(line) - n, " %6.2f %6.2f",
+                 h.count ? h.sumUs / 1000.0 / h.count : 0.0, h.maxUs / 1000.0);
+        Serial.println(line);
+    }
+}
+
+void serialService() {
+    static String cmd;
+    while (Serial.available()) {
+        char ch = Serial.read();
+        if (ch != '\n' && ch != '\r') {
+            if (cmd.length() < 32) cmd += ch;
+            continue;
+        }
+        cmd.trim();
+        if (cmd == "hist") histDump();
+        else if (cmd == "hist reset") {
+            memset(uiHist, 0, sizeof(uiHist));
+            Serial.println("[HIST] Cleared");
+        } else if (cmd.length()) Serial.printf("[SERIAL] Unknown command: %s\n", cmd.c_str());
+        cmd = "";
+    }
 }
 
+// ── Band renderer ──
+// There is no full-screen framebuffer. A frame is drawn band by band into
+// two UI_BAND_H-row DMA buffers: for each band, canvas is pointed at a
+// virtual full-screen buffer whose rows [y, y + h) are the band and is
+// clipped to those rows, so scene functions draw in screen coordinates
+// and simply run once per band. While one band goes out over SPI DMA the
+// next is drawn into the other buffer (pushImageDMA waits for the previous
+// transfer before starting). The last band is still in flight when
+// renderFrame() returns; the next frame waits for it in canvasBegin().
+//
+// Scene functions run several times per frame, so they read per-frame
+// inputs from `frame` (time, visualizer data, battery) and update their
+// own state only when frame.first is set.
+struct FrameSnap {
+    uint32_t ms;
+    uint8_t  bins[VIS_BINS];
+    int8_t   wave[VIS_WAVE_N];
+    int      waveW;
+    uint16_t peak;
+    int      batt;
+    bool     charging;
+    bool     first;      // drawing the first band of the frame
+};
+FrameSnap frame;
+uint16_t *bandBuf[2] = {nullptr, nullptr};
+int       bandY = 0, bandH = SCREEN_H;   // rows being drawn
+bool      dispDma = false;   // last band in flight (display transaction held open)
+void    (*uiPrevScene)() = nullptr;   // scene of the previous frame
+
+bool bandsBegin() {
+    for (auto &b : bandBuf)
+        b = (uint16_t *)heap_caps_malloc(SCREEN_W * UI_BAND_H * 2,
+                                         MALLOC_CAP_DMA | MALLOC_CAP_8BIT);
+    Serial.printf("[UI] Band renderer: 2 x %u B (a full frame is %u B), heap=%u\n",
+                  SCREEN_W * UI_BAND_H * 2, SCREEN_W * SCREEN_H * 2, ESP.getFreeHeap());
+    return bandBuf[0] && bandBuf[1];
+}
+
+void canvasBegin() {
+    if (!dispDma) return;
+    uint32_t t = micros();
+    M5.Display.waitDMA();
+    M5.Display.endWrite();
+    dispDma = false;
+    uiLayerUs[LAYER_WAIT] += micros() - t;
+}
+
+// Drawn over the scene in every band, from the previous frame's numbers
+void drawDebugOverlay() {
+    const int w = 96, h = 39, x = SCREEN_W - w - 2, y = SCREEN_H - FOOTER_H - h - 2;
+    if (y + h <= bandY || y >= bandY + bandH) return;
+    canvas.fillRect(x, y, w, h, C_BG_DARK);
+    canvas.drawRect(x, y, w, h, C_DARKGRAY);
+    canvas.setFont(&fonts::Font0);
+    canvas.setTextDatum(TL_DATUM);
+    canvas.setTextColor(C_ACCENT);
+    char line[24];
+    snprintf(line, sizeof(line), "%2u fps %4u/m %4.1f", uiFps, uiFpm,
+             uiLastUs[HIST_FRAME] / 1000.0f);
+    canvas.drawString(line, x + 3, y + 3);
+    snprintf(line, sizeof(line), "h%.1f b%.1f f%.1f", uiLastUs[LAYER_HEADER] / 1000.0f,
+             uiLastUs[LAYER_BODY] / 1000.0f, uiLastUs[LAYER_FOOTER] / 1000.0f);
+    canvas.drawString(line, x + 3, y + 12);
+    snprintf(line, sizeof(line), "p%.1f w%.1f k%u", uiLastUs[LAYER_PUSH] / 1000.0f,
+             uiLastUs[LAYER_WAIT] / 1000.0f, uiLastUs[HIST_KEY] / 1000);
+    canvas.drawString(line, x + 3, y + 21);
+    if (battMinsLeft >= 0)
+        snprintf(line, sizeof(line), "bat %d%% ~%d:%02d", battLevel, battMinsLeft / 60,
+                 battMinsLeft % 60);
+    else
+        snprintf(line, sizeof(line), "bat %d%%%s", battLevel, battCharging ? " chg" : "");
+    canvas.drawString(line, x + 3, y + 30);
+}
+
+void renderFrame(void (*scene)()) {
+    if (!bandBuf[1]) return;
+    uint32_t t0 = micros();
+    uint32_t layer0[LAYER_COUNT];
+    memcpy(layer0, uiLayerUs, sizeof(layer0));
+    canvasBegin();
+    frame.ms = millis();
+    for (int i = 0; i < VIS_BINS; i++) frame.bins[i] = visBins[i];
+    for (int i = 0; i < VIS_WAVE_N; i++) frame.wave[i] = visWave[i];
+    frame.waveW    = visWaveW;
+    frame.peak     = visPeak;
+    frame.batt     = max(0, battLevel);
+    frame.charging = battCharging;
+
+    M5.Display.startWrite();
+    for (int i = 0, y = 0; y < SCREEN_H; i++, y += UI_BAND_H) {
+        int h = min(UI_BAND_H, SCREEN_H - y);
+        uint16_t *buf = bandBuf[i & 1];
+        canvas.setBuffer(buf - y * SCREEN_W, SCREEN_W, SCREEN_H);
+        canvas.setClipRect(0, y, SCREEN_W, h);
+        bandY = y;
+        bandH = h;
+        frame.first = i == 0;
+        scene();
+        if (uiDebug) drawDebugOverlay();
+        uint32_t t = micros();
+        M5.Display.pushImageDMA(0, y, SCREEN_W, h, (const lgfx::swap565_t *)buf);
+        uiLap(LAYER_PUSH, t);
+    }
+    dispDma = true;
+    uiPrevScene = scene;
+    uiFrames++;
+    uiFpmN++;
+
+    for (int i = 0; i < LAYER_COUNT; i++) histAdd(i, uiLayerUs[i] - layer0[i]);
+    histAdd(HIST_FRAME, micros() - t0);
+    if (uiKeyWait) {
+        // The key's effect is on screen once the last band has gone out
+        M5.Display.waitDMA();
+        histAdd(HIST_KEY, micros() - uiKeyUs);
+        uiKeyWait = false;
+    }
+    uiFpsN++;
+    if (millis() - uiFpsFrom >= 1000) {
+        uiFps     = uiFpsN * 1000 / (millis() - uiFpsFrom);
+        uiFpsN    = 0;
+        uiFpsFrom = millis();
+    }
+    if (uiDebug) uiFrameIn(1000);   // keep the overlay's numbers fresh
+}
+
+// Narrow the clip to a rect inside the current band; restore with popClip
+struct ClipSave { int32_t x, y, w, h; };
+
+ClipSave pushClip(M5Canvas &c, int x, int y, int w, int h) {
+    ClipSave old;
+    c.getClipRect(&old.x, &old.y, &old.w, &old.h);
+    int x0 = max((int)old.x, x), y0 = max((int)old.y, y);
+    int x1 = min((int)(old.x + old.w), x + w), y1 = min((int)(old.y + old.h), y + h);
+    c.setClipRect(x0, y0, max(0, x1 - x0), max(0, y1 - y0));
+    return old;
+}
+
+void popClip(M5Canvas &c, const ClipSave &old) { c.setClipRect(old.x, old.y, old.w, old.h); }
+
 bool hasKey(const std::vector<char> &word, char ch) {
     return std::find(word.begin(), word.end(), ch) != word.end();
 }
 
+// ── Text metrics ──
+// Advance widths of printable ASCII, measured once per font, so the width
+// of a prefix is a running sum instead of a textWidth() call. Strings with
+// other bytes (UTF-8) are still measured with textWidth().
+#define FONT_ADV_MAX 6
+struct FontAdv {
+    const void *font;
+    uint8_t     adv[95];   // ' ' .. '~'
+};
+FontAdv fontAdv[FONT_ADV_MAX];
+int     fontAdvN = 0;
+
+const uint8_t *fontAdvance(M5Canvas &c) {
+    const void *font = c.getFont();
+    for (int i = 0; i < fontAdvN; i++)
+        if (fontAdv[i].font == font) return fontAdv[i].adv;
+    if (fontAdvN == FONT_ADV_MAX) return nullptr;
+    FontAdv &f = fontAdv[fontAdvN++];
+    f.font = font;
+    char g[2] = {0, 0};
+    for (int ch = 32; ch < 127; ch++) {
+        g[0] = ch;
+        f.adv[ch - 32] = c.textWidth(g);
+    }
+    return f.adv;
+}
+
+// Recent fitText() results per (string, font, width); rows are redrawn
+// once per band and frame with the same few strings
+#define FIT_MEMO 24
+struct FitMemo {
+    uint32_t    hash;
+    const void *font;
+    int         maxPx;
+    String      src, out;
+};
+FitMemo fitMemo[FIT_MEMO];
+int     fitMemoNext = 0;
+
 // Truncate string to fit within maxPx pixels (using current canvas font)
 String fitText(M5Canvas &c, const String &s, int maxPx) {
-    if (c.textWidth(s) <= maxPx) return s;
-    for (int len = s.length() - 1; len > 0; len--) {
-        String t = s.substring(0, len) + "~";
-        if (c.textWidth(t) <= maxPx) return t;
+    const void *font = c.getFont();
+    int n = s.length();
+    uint32_t h = textHash(s.c_str(), n);
+    for (auto &m : fitMemo)
+        if (m.hash == h && m.font == font && m.maxPx == maxPx && m.src == s) return m.out;
+
+    // Prefix widths from the advance table when every byte is in it
+    const uint8_t *adv = n <= 128 ? fontAdvance(c) : nullptr;
+    uint16_t pre[129];
+    if (adv && !prefixWidths(s.c_str(), n, adv, pre)) adv = nullptr;
+    auto width = [&](int len) -> int {
+        return adv ? pre[len] : c.textWidth(s.substring(0, len));
+    };
+
+    String out;
+    if (width(n) <= maxPx) {
+        out = s;
+    } else {
+        // Longest prefix that fits with the "~"
+        int lo = fitPrefixLen(n, maxPx, c.textWidth("~"), width);
+        out = lo > 0 ? s.substring(0, lo) + "~" : String("~");
     }
-    return "~";
+
+    FitMemo &m = fitMemo[fitMemoNext];
+    fitMemoNext = (fitMemoNext + 1) % FIT_MEMO;
+    m.hash  = h;
+    m.font  = font;
+    m.maxPx = maxPx;
+    m.src   = s;
+    m.out   = out;
+    return out;
 }
 
 // Car-radio scrolling text: scrolls if text exceeds maxW, otherwise draws normally.
-// Uses TL_DATUM. Font must be set before calling.
+// Uses TL_DATUM. Font and colour must be set before calling (the colour is
+// passed too, for the strip). The width is measured only when the text,
+// font or colour change; scrolling text is rasterised once into a 1-bit
+// strip of text + gap over C_BG, then blitted at the scroll offset.
 void drawScrollText(M5Canvas &c, const String &s, int x, int y,
-                    int maxW, ScrollState &ss) {
-    int tw = c.textWidth(s);
-    if (tw <= maxW) {
+                    int maxW, ScrollState &ss, uint16_t color) {
+    const void *font = c.getFont();
+    if (s != ss.text || font != ss.font || color != ss.color) {
+        ss.text      = s;   // reset scroll on text change
+        ss.font      = font;
+        ss.color     = color;
+        ss.fullWidth = c.textWidth(s);
+        ss.startMs   = frame.ms;
+        ss.strip.deleteSprite();
+    }
+    if (ss.fullWidth <= maxW) {
         c.drawString(s, x, y);
-        ss.text = "";
         return;
     }
-    // Reset scroll on text change
-    if (s != ss.text) {
-        ss.text      = s;
-        ss.fullWidth = tw;
-        ss.startMs   = millis();
-    }
-    unsigned long elapsed = millis() - ss.startMs;
+    unsigned long elapsed = frame.ms - ss.startMs;
     int pause = 2000;     // ms to show start before scrolling
     int speed = 35;       // px/sec
     int gap   = 50;       // px gap before text repeats
@@ -278,13 +894,34 @@ void drawScrollText(M5Canvas &c, const String &s, int x, int y,
     int offset = 0;
     if (elapsed > (unsigned long)pause) {
         offset = (int)((elapsed - pause) * speed / 1000) % cycle;
+        uiFrameIn(UI_SCROLL_MS);
+    } else {
+        uiFrameIn(pause - elapsed);
     }
 
     int fh = c.fontHeight();
-    c.setClipRect(x, y, maxW, fh);
-    c.drawString(s, x - offset, y);
-    c.drawString(s, x - offset + cycle, y);
-    c.clearClipRect();
+    if (y + fh <= bandY || y >= bandY + bandH) return;  // not in this band
+    if (!ss.strip.getBuffer()) {
+        ss.strip.setColorDepth(1);
+        if (ss.strip.createSprite(cycle, fh)) {
+            ss.strip.setPaletteColor(0, C_BG);
+            ss.strip.setPaletteColor(1, color);
+            ss.strip.fillSprite(0);
+            ss.strip.setFont(c.getFont());
+            ss.strip.setTextDatum(TL_DATUM);
+            ss.strip.setTextColor(1);
+            ss.strip.drawString(s, 0, 0);
+        }
+    }
+    ClipSave band = pushClip(c, x, y, maxW, fh);
+    if (ss.strip.getBuffer()) {
+        ss.strip.pushSprite(&c, x - offset, y);
+        ss.strip.pushSprite(&c, x - offset + cycle, y);
+    } else {  // no memory for the strip: draw the glyphs directly
+        c.drawString(s, x - offset, y);
+        c.drawString(s, x - offset + cycle, y);
+    }
+    popClip(c, band);
 }
 
 // ═══════════════════════════════════════════════════════════
@@ -309,6 +946,27 @@ void es8311_init_dac() {
     wr(0x37, 0x08);  // Bypass DAC equalizer
 }
 
+// ── Crossfade voice: the outgoing decoder renders into a small mono ring ──
+// DirectI2SOutput pulls from it while the incoming decoder plays, so both
+// decoders run on the audio task without a second I2S path.
+#define XF_RING_N  2048   // mono samples, more than one MP3 frame (1152)
+
+class MixVoice : public AudioOutput {
+public:
+    bool alloc() { return _ring.alloc(); }
+    bool pop(int16_t &s) { return _ring.pop(s); }
+    bool ConsumeSample(int16_t sample[2]) override {
+        return _ring.push(((int32_t)sample[LEFTCHANNEL] + sample[RIGHTCHANNEL]) / 2);
+    }
+    bool begin() override { return true; }
+    bool stop() override { _ring.clear(); return true; }
+    bool SetBitsPerSample(int bits) override { return (bits == 16); }
+    bool SetChannels(int) override { return true; }
+
+private:
+    MonoRing<XF_RING_N> _ring;
+};
+
 class DirectI2SOutput : public AudioOutput {
 public:
     DirectI2SOutput(i2s_port_t port, int bck, int ws, int dout)
@@ -326,7 +984,7 @@ public:
         cfg.channel_format = I2S_CHANNEL_FMT_RIGHT_LEFT;
         cfg.communication_format = I2S_COMM_FORMAT_STAND_I2S;
         cfg.intr_alloc_flags = ESP_INTR_FLAG_LEVEL1;
-        cfg.dma_buf_count = 8;
+        cfg.dma_buf_count = DMA_FRAMES / 128;
         cfg.dma_buf_len = 128;
         cfg.use_apll = false;
         cfg.tx_desc_auto_clear = true;
@@ -349,14 +1007,48 @@ public:
 
     bool stop() override {
         _bp = 0;
+        restartDeadline();
+        _xf = nullptr;
+        _xfGen = nullptr;
         if (_started) i2s_zero_dma_buffer(_port);
         return true;
     }
 
+    // Mix gen (rendering into v) out under the incoming stream over n samples
+    void startFade(MixVoice *v, AudioGenerator *gen, uint32_t n) {
+        _ramp.start(n);
+        _xfUs  = 0;
+        _xfGen = gen;
+        _xf    = v;
+    }
+    bool fading() const { return _xf != nullptr; }
+
+    // Audio queued in DMA after the last write; low means the decoder is
+    // only just keeping up
+    uint32_t slackUs() const { return _slackUs; }
+    // Forget the projected deadline (after an intentional gap in output)
+    void restartDeadline() { _due = 0; _slackUs = UINT32_MAX; }
+    uint32_t fadeDecodeUs() const { return _xfUs; }
+
+    // Time-shift catch-up: clock the DMA pct percent fast and drop quiet
+    // runs, so a delayed stream drains back to live (0 = normal)
+    void setSpeed(int pct) {
+        if (pct == _speedPct) return;
+        _speedPct = pct;
+        _quietRun = 0;
+        if (_started) i2s_set_sample_rates(_port, outRate());
+        Serial.printf("[TSHIFT] Playback at %d%%\n", 100 + pct);
+    }
+
     bool ConsumeSample(int16_t sample[2]) override {
         if (aCmd != ACMD_NONE) return false;
 
         int16_t raw = ((int32_t)sample[LEFTCHANNEL] + sample[RIGHTCHANNEL]) / 2;
+        if (_xf) raw = mixFade(raw);
+        if (_speedPct) {   // catching up: skip quiet beyond the first 10 ms
+            _quietRun = (raw > -QUIET && raw < QUIET) ? _quietRun + 1 : 0;
+            if (_quietRun > 441) return true;
+        }
         int16_t mono;
         if (aPaused) {
             mono = 0;
@@ -395,7 +1087,12 @@ public:
 
         if (_bp >= BUF_SZ) {
             size_t written = 0;
+            uint32_t t0 = micros();
             i2s_write(_port, _buf, _bp * sizeof(int16_t), &written, pdMS_TO_TICKS(50));
+            uint32_t t1 = micros();
+            aI2sWaitUs += t1 - t0;
+            trackDeadline(t0, t1, written);
+            if (!tFirstAudio) tFirstAudio = millis();
             _bp = 0;
         }
         return true;
@@ -403,7 +1100,7 @@ public:
 
     bool SetRate(int hz) override {
         hertz = hz;
-        if (_started) i2s_set_sample_rates(_port, hz);
+        if (_started) i2s_set_sample_rates(_port, outRate());
         return true;
     }
 
@@ -411,41 +1108,477 @@ public:
     bool SetChannels(int ch) override { return true; }
 
 private:
+    // Project when the DMA queue runs dry. A write that blocked left the
+    // queue full; otherwise the chunk extends the previous projection. A
+    // write that starts past the projection was late: the DMA played
+    // silence (tx_desc_auto_clear) in between.
+    void trackDeadline(uint32_t t0, uint32_t t1, size_t bytes) {
+        uint32_t hz = outRate();
+        if (_due && (int32_t)(t0 - _due) > 0) aDecodeMiss++;
+        if (t1 - t0 > 1000) {
+            _due = t1 + (uint32_t)((uint64_t)DMA_FRAMES * 1000000 / hz);
+        } else {
+            uint32_t base = (_due && (int32_t)(_due - t0) > 0) ? _due : t0;
+            _due = base + (uint32_t)((uint64_t)(bytes / 4) * 1000000 / hz);
+        }
+        _slackUs = (int32_t)(_due - t1) > 0 ? _due - t1 : 0;
+    }
+
+    // Q15 linear ramp; the outgoing decoder is run only when its ring is empty
+    int16_t mixFade(int16_t in) {
+        int16_t old = 0;
+        if (!_xf->pop(old) && _xfGen->isRunning()) {
+            uint32_t t0 = micros();
+            _xfGen->loop();
+            _xfUs += micros() - t0;
+            _xf->pop(old);
+        }
+        int16_t m = _ramp.mix(in, old);
+        if (_ramp.done()) { _xf = nullptr; _xfGen = nullptr; }
+        return m;
+    }
+
+    uint32_t outRate() const {
+        return (uint32_t)(hertz > 0 ? hertz : 44100) * (100 + _speedPct) / 100;
+    }
+
     static const int BUF_SZ = 512;  // 256 stereo sample pairs
+    static const int QUIET  = 256;  // about -42 dBFS
+    static const uint32_t DMA_FRAMES = 1024;  // 8 DMA buffers of 128 frames
     int16_t _buf[BUF_SZ];
     int _bp;
     i2s_port_t _port;
     int _bck, _ws, _dout;
     bool _started;
+    MixVoice       *_xf    = nullptr;
+    AudioGenerator *_xfGen = nullptr;
+    FadeRamp _ramp;
+    uint32_t _xfUs = 0;
+    int      _speedPct = 0;
+    uint32_t _quietRun = 0;
+    uint32_t _due = 0, _slackUs = UINT32_MAX;
 };
 
 // ═══════════════════════════════════════════════════════════
-//  WIFI
+//  TIME-SHIFT (keep recording while paused, resume from pause point)
 // ═══════════════════════════════════════════════════════════
-void startWifiScan() {
-    scanCount = 0;
-    scanSelectedIdx = 0;
-    scanScrollOff   = 0;
-    wifiError = "";
+// While paused, the audio task moves stream bytes from the socket into
+// tsIn. tsTask (Core 1) owns the ring file on SD or LittleFS and moves
+// tsIn → file → tsOut, so storage latency never blocks the decoder. After
+// resume the chain reads from tsOut until the user jumps back to live.
+#define TS_PATH      "/timeshift.mp3"
+#define TS_CHUNK     2048
+#define TS_IN_SIZE   6144
+#define TS_OUT_SIZE  4096
+
+ByteFifo          tsIn, tsOut;
+volatile uint32_t tsWant     = 0;   // session requested by the audio task (0 = off)
+volatile uint32_t tsHave     = 0;   // session tsTask has set up
+volatile bool     tsFailed   = false;
+volatile uint32_t tsLagBytes = 0;   // audio recorded but not yet played
+volatile bool     tsDrained  = false;  // ring ran empty after resume: back to live next
+uint32_t          tsSeq      = 0;
+
+bool tsReady() { return tsWant != 0 && tsHave == tsWant; }
+
+void tsBegin() {
+    if (TIMESHIFT_KB <= 0 || tsWant != 0) return;
+    tsFailed = false;
+    if (++tsSeq == 0) tsSeq = 1;
+    tsWant = tsSeq;
+}
 
-    // Show scanning message
-    canvas.fillSprite(C_BG);
-    canvas.setTextDatum(MC_DATUM);
-    canvas.setFont(&fonts::FreeSansBold9pt7b);
-    canvas.setTextColor(C_ACCENT);
-    canvas.drawString("SOMA FM", SCREEN_W / 2, 40);
-    canvas.setFont(&fonts::Font2);
-    canvas.setTextColor(C_WHITE);
-    canvas.drawString("Scanning networks...", SCREEN_W / 2, 75);
-    canvas.pushSprite(0, 0);
+void tsEnd() { tsWant = 0; }
 
-    WiFi.mode(WIFI_STA);
-    WiFi.disconnect();
-    delay(100);
-    int n = WiFi.scanNetworks();
-    Serial.printf("[WIFI] Scan found %d networks\n", n);
+// Seconds of delay behind the live stream while time-shifted
+int tsLagSeconds() {
+    return tsReady() ? (int)(tsLagBytes / (STREAM_BITRATE * 125)) : 0;
+}
+
+void tsTask(void *) {
+    File     f;
+    fs::FS  *ringFs = nullptr; // filesystem f was opened on (SD mounts late)
+    uint8_t *chunk  = nullptr;
+    uint32_t served = 0;       // session id this loop has acted on
+    TsRing<File> ring;
+    uint32_t wBytes = 0, wUs = 0, wMaxUs = 0;
+    unsigned long tLog = 0;
+
+    for (;;) {
+        if (served != tsWant) {
+            // Tear down the previous session before honoring the new request
+            tsHave = 0;
+            if (f) { f.close(); ringFs->remove(TS_PATH); }
+            free(chunk); chunk = nullptr;
+            tsIn.release();
+            tsOut.release();
+            tsLagBytes = 0;
+            tsDrained  = false;
+            served = tsWant;
+
+            if (served != 0) {
+                bool onSd = sdMounted;
+                ringFs = onSd ? (fs::FS *)&SD : (fs::FS *)&LittleFS;
+                uint32_t cap = (onSd ? TIMESHIFT_SD_KB : TIMESHIFT_KB) * 1024UL;
+                if (!onSd) {
+                    // Leave room on LittleFS for the logo cache
+                    size_t avail = LittleFS.totalBytes() - LittleFS.usedBytes();
+                    cap = (avail > 65536) ? min((size_t)cap, avail - 65536) : 0;
+                }
+                cap -= cap % TS_CHUNK;
+                ring.reset(&f, cap);
+                wBytes = wUs = wMaxUs = 0;
+                tLog = millis();
+                f = ringFs->open(TS_PATH, "w+");
+                chunk = (uint8_t *)malloc(TS_CHUNK);
+                if (cap >= 16 * TS_CHUNK && f && chunk &&
+                    tsIn.alloc(TS_IN_SIZE) && tsOut.alloc(TS_OUT_SIZE)) {
+                    tsHave = served;
+                    Serial.printf("[TSHIFT] Ring %u KB on %s\n", cap / 1024,
+                                  onSd ? "SD" : "LittleFS");
+                } else {
+                    Serial.println("[TSHIFT] Setup failed, pause will hold the stream");
+                    tsFailed = true;
+                }
+            }
+        }
+
+        if (tsHave == 0 || tsHave != tsWant) {
+            vTaskDelay(pdMS_TO_TICKS(50));
+            continue;
+        }
+
+        // Playback has caught up once the ring runs empty after resume.
+        // From then on (for the rest of the session, even if paused again)
+        // bytes bypass the file and the audio task stops feeding tsIn, so
+        // both FIFOs drain and it can switch back to the socket
+        if (!tsDrained && !aPaused && ring.stored() == 0) tsDrained = true;
+
+        if (tsDrained) {
+            while (fifoPass(tsIn, tsOut, chunk, TS_CHUNK) && tsHave == tsWant) {}
+        } else {
+            // Network → ring, in whole chunks to keep flash/SD writes efficient
+            while (tsHave == tsWant) {
+                uint32_t t0 = micros();
+                uint32_t n  = ring.store(tsIn, chunk, TS_CHUNK);
+                if (n == 0) break;
+                uint32_t dt = micros() - t0;
+                wUs += dt;
+                wMaxUs = max(wMaxUs, dt);
+                wBytes += n;
+            }
+            // Ring → playback read-ahead once resumed
+            while (!aPaused && tsHave == tsWant && ring.load(tsOut, chunk, TS_CHUNK)) {}
+        }
+
+        tsLagBytes = ring.stored() + tsIn.used() + tsOut.used();
+
+        if (millis() - tLog >= 10000) {
+            Serial.printf("[TSHIFT] write %u KB/s (max %u ms/chunk), lag=%u s\n",
+                          wUs ? (uint32_t)((uint64_t)wBytes * 1000 / wUs) : 0,
+                          wMaxUs / 1000, tsLagBytes / (STREAM_BITRATE * 125));
+            wBytes = wUs = wMaxUs = 0;
+            tLog = millis();
+        }
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+}
+
+// Sits between the HTTP source and AudioFileSourceBuffer. Pass-through
+// until pump() starts recording, then serves playback from tsOut.
+class AudioFileSourceTimeShift : public AudioFileSource {
+public:
+    explicit AudioFileSourceTimeShift(AudioFileSource *src) : _src(src), _shifting(false) {}
+
+    // Audio task: move whatever the socket has buffered into tsIn
+    void pump() {
+        if (!tsReady()) return;
+        _shifting = true;
+        uint8_t tmp[512];
+        for (int i = 0; i < 8; i++) {
+            uint32_t room = min((uint32_t)sizeof(tmp), tsIn.space());
+            if (room == 0) break;
+            uint32_t n = _src->readNonBlock(tmp, room);
+            if (n == 0) break;
+            tsIn.push(tmp, n);
+        }
+    }
+
+    bool shifting() const { return _shifting; }
+
+    uint32_t read(void *data, uint32_t len) override { return readInternal(data, len, true); }
+    uint32_t readNonBlock(void *data, uint32_t len) override { return readInternal(data, len, false); }
+    bool seek(int32_t, int) override { return false; }
+    bool close() override { return _src->close(); }
+    bool isOpen() override { return _shifting || _src->isOpen(); }
+    uint32_t getSize() override { return _src->getSize(); }
+    uint32_t getPos() override { return _src->getPos(); }
+    bool loop() override { return _src->loop(); }
+
+private:
+    uint32_t readInternal(void *data, uint32_t len, bool block) {
+        if (_shifting && tsReady()) {
+            // Keep recording the live stream behind playback until caught up
+            bool drained = tsDrained;
+            if (!drained) pump();
+            uint32_t n = tsOut.pop((uint8_t *)data, len);
+            for (int i = 0; block && n == 0 && i < 20 && tsReady(); i++) {
+                if (drained && tsIn.used() == 0) break;
+                vTaskDelay(pdMS_TO_TICKS(10));
+                if (!drained) pump();
+                n = tsOut.pop((uint8_t *)data, len);
+            }
+            // Caught up and both FIFOs empty (tsIn first: nothing is in
+            // flight then): the socket continues right where the ring ended
+            if (n || !drained || tsIn.used() || tsOut.used()) return n;
+            Serial.println("[TSHIFT] Caught up, back to live");
+            tsEnd();
+        }
+        _shifting = false;  // session ended or never started
+        return block ? _src->read(data, len) : _src->readNonBlock(data, len);
+    }
+
+    AudioFileSource *_src;
+    bool _shifting;
+};
+
+// ═══════════════════════════════════════════════════════════
+//  RECORDING (tee the MP3 bitstream to microSD)
+// ═══════════════════════════════════════════════════════════
+// The tee copies network bytes once into aligned REC_BLOCK_SIZE blocks and
+// queues them to recWriterTask (Core 1), which owns the SD file. When no
+// free block or queue slot is available the data is dropped and counted
+// rather than ever blocking audioTask. Files are split on ICY StreamTitle changes.
+#define REC_DIR   "/rec"
+#define REC_DATA  0
+#define REC_SPLIT 1
+#define REC_STOP  2
+
+struct RecMsg {
+    uint8_t  kind;
+    uint32_t len;
+    uint8_t *blk;
+    char     name[64];   // REC_SPLIT: label for the next file
+};
+
+QueueHandle_t recFreeQ = nullptr;   // empty blocks (uint8_t *)
+QueueHandle_t recFullQ = nullptr;   // RecMsg for the writer
+volatile bool recWant  = false;     // UI request
+volatile bool recOn    = false;     // audio task is teeing
+uint8_t      *recPool  = nullptr;
+bool          recDraining    = false;
+bool          recStopPending = false;  // REC_STOP not yet queued
+char          recStation[24] = "";
+
+portMUX_TYPE  recMux   = portMUX_INITIALIZER_UNLOCKED;
+char          recSplitTitle[64] = "";
+volatile bool recSplitPending   = false;
+
+// Any task: start a new file at the next block boundary
+void recRequestSplit(const char *title) {
+    portENTER_CRITICAL(&recMux);
+    strlcpy(recSplitTitle, title ? title : "", sizeof(recSplitTitle));
+    recSplitPending = true;
+    portEXIT_CRITICAL(&recMux);
+}
+
+uint8_t *recTakeBlock() {
+    uint8_t *b;
+    return xQueueReceive(recFreeQ, &b, 0) == pdTRUE ? b : nullptr;
+}
+
+// Splits share recFullQ with data, so it can be full even with blocks free
+bool recGiveBlock(uint8_t *blk, uint32_t len) {
+    RecMsg m = {};
+    m.kind = REC_DATA;
+    m.len  = len;
+    m.blk  = blk;
+    return xQueueSend(recFullQ, &m, 0) == pdTRUE;
+}
+
+BlockTee recTee(REC_BLOCK_SIZE, recTakeBlock, recGiveBlock);  // audio task only
+
+// Audio task: copy stream bytes into the current block
+void recFeed(const uint8_t *data, uint32_t len) {
+    if (!recOn) return;
+    if (recSplitPending) {
+        RecMsg m = {};
+        m.kind = REC_SPLIT;
+        char title[sizeof(recSplitTitle)];
+        portENTER_CRITICAL(&recMux);
+        strlcpy(title, recSplitTitle, sizeof(title));
+        recSplitPending = false;
+        portEXIT_CRITICAL(&recMux);
+        snprintf(m.name, sizeof(m.name), "%s-%s", recStation, title);
+        recTee.flush();
+        xQueueSend(recFullQ, &m, 0);  // a lost split only merges two tracks
+    }
+    recTee.feed(data, len);
+}
+
+// Audio task: apply start/stop requests and release the pool when idle
+void recService() {
+    if (recWant && !recOn && !recDraining && !recStopPending) {
+        recPool = (uint8_t *)heap_caps_aligned_alloc(
+            32, (size_t)REC_BLOCK_SIZE * REC_BLOCKS, MALLOC_CAP_DMA);
+        if (!recPool) {
+            Serial.println("[REC] No memory for write blocks");
+            recWant = false;
+            return;
+        }
+        for (int i = 0; i < REC_BLOCKS; i++) {
+            uint8_t *b = recPool + i * REC_BLOCK_SIZE;
+            xQueueSend(recFreeQ, &b, 0);
+        }
+        recTee.reset();
+        recOn = true;
+        if (playingIdx >= 0) {
+            char title[sizeof(icyTitle)];
+            portENTER_CRITICAL(&icyMux);
+            strlcpy(title, icyTitle, sizeof(title));
+            portEXIT_CRITICAL(&icyMux);
+            recRequestSplit(title);
+        }
+    } else if (!recWant && recOn) {
+        recOn = false;
+        recTee.flush();
+        if (recTee.cur) xQueueSend(recFreeQ, &recTee.cur, 0);  // unsent, back to the pool
+        recTee.cur     = nullptr;
+        recStopPending = true;
+    }
+    if (recStopPending) {
+        RecMsg m = {};
+        m.kind = REC_STOP;
+        if (xQueueSend(recFullQ, &m, 0) == pdTRUE) {  // full: retry next pass
+            recStopPending = false;
+            recDraining    = true;
+        }
+    } else if (recDraining && uxQueueMessagesWaiting(recFreeQ) == REC_BLOCKS) {
+        uint8_t *b;
+        while (xQueueReceive(recFreeQ, &b, 0) == pdTRUE) {}
+        heap_caps_free(recPool);
+        recPool     = nullptr;
+        recDraining = false;
+    }
+}
+
+String recFileName(const char *label, int n) {
+    String name = "";
+    for (const char *p = label; *p && name.length() < 48; p++) {
+        char ch = *p;
+        if (isalnum((unsigned char)ch) || ch == '-' || ch == '_' || ch == ' ') name += ch;
+    }
+    name.trim();
+    char num[8];
+    snprintf(num, sizeof(num), "%04d", n);
+    return String(REC_DIR) + "/" + num + "-" + name + ".mp3";
+}
+
+void recWriterTask(void *) {
+    File     f;
+    String   nextName = "";
+    int      fileNo   = 0;
+    uint32_t bytes = 0, busyUs = 0, maxUs = 0;
+    unsigned long tStart = 0;
+
+    // Continue numbering after the highest existing recording
+    if (!SD.exists(REC_DIR)) SD.mkdir(REC_DIR);
+    File dir = SD.open(REC_DIR);
+    for (File e = dir.openNextFile(); e; e = dir.openNextFile())
+        fileNo = max(fileNo, atoi(e.name()));
+    dir.close();
+
+    for (;;) {
+        RecMsg m;
+        if (xQueueReceive(recFullQ, &m, portMAX_DELAY) != pdTRUE) continue;
+
+        if (m.kind == REC_DATA) {
+            if (!f) {
+                if (nextName.length() == 0) nextName = recFileName("stream", ++fileNo);
+                f = SD.open(nextName, FILE_WRITE);
+                Serial.printf("[REC] %s %s\n", f ? "Writing" : "Cannot create",
+                              nextName.c_str());
+                nextName = "";
+                if (tStart == 0) tStart = millis();
+            }
+            uint32_t t0 = micros();
+            if (f) f.write(m.blk, m.len);
+            uint32_t dt = micros() - t0;
+            busyUs += dt;
+            maxUs = max(maxUs, dt);
+            bytes += m.len;
+            xQueueSend(recFreeQ, &m.blk, 0);
+            continue;
+        }
+
+        // Split or stop: close the current file and report write statistics
+        if (f) f.close();
+        if (tStart) {
+            unsigned long wall = max(1UL, millis() - tStart);
+            Serial.printf("[REC] %u KB in %lu s, card busy %u%%, worst write %u ms, dropped %u B\n",
+                          bytes / 1024, wall / 1000,
+                          (uint32_t)((uint64_t)busyUs / 10 / wall), maxUs / 1000,
+                          recTee.dropped);
+        }
+        bytes = busyUs = maxUs = 0;
+        tStart = 0;
+        nextName = (m.kind == REC_SPLIT) ? recFileName(m.name, ++fileNo) : "";
+    }
+}
+
+// Pass-through source that hands every byte read from the socket to recFeed()
+class AudioFileSourceTee : public AudioFileSource {
+public:
+    explicit AudioFileSourceTee(AudioFileSource *src) : _src(src), _mute(false) {}
+
+    void mute() { _mute = true; }  // outgoing stream of a crossfade
+
+    uint32_t read(void *data, uint32_t len) override {
+        uint32_t n = _src->read(data, len);
+        if (!_mute) recFeed((const uint8_t *)data, n);
+        return n;
+    }
+    uint32_t readNonBlock(void *data, uint32_t len) override {
+        uint32_t n = _src->readNonBlock(data, len);
+        if (!_mute) recFeed((const uint8_t *)data, n);
+        return n;
+    }
+    bool seek(int32_t, int) override { return false; }
+    bool close() override { return _src->close(); }
+    bool isOpen() override { return _src->isOpen(); }
+    uint32_t getSize() override { return _src->getSize(); }
+    uint32_t getPos() override { return _src->getPos(); }
+    bool loop() override { return _src->loop(); }
+
+private:
+    AudioFileSource *_src;
+    bool _mute;
+};
+
+// ICY StreamTitle arrives inside the audio stream (audio task context)
+void icyMetadataCB(void *, const char *type, bool, const char *str) {
+    if (strcmp(type, "StreamTitle") != 0 || !str || !*str) return;
+    portENTER_CRITICAL(&icyMux);
+    bool changed = strcmp(icyTitle, str) != 0;
+    strlcpy(icyTitle, str, sizeof(icyTitle));
+    if (changed) icySeq++;
+    portEXIT_CRITICAL(&icyMux);
+    icyActive = true;
+    if (changed && recOn) recRequestSplit(str);
+}
 
-    for (int i = 0; i < n && scanCount < MAX_SCAN_RESULTS; i++) {
+// ═══════════════════════════════════════════════════════════
+//  WIFI
+// ═══════════════════════════════════════════════════════════
+// Scans run one channel at a time in the background; loop() polls each
+// channel and merges its results, so the list fills in while the UI stays live
+#define WIFI_SCAN_LAST_CH 13
+#define WIFI_SCAN_CH_MS   120
+#define WIFI_CONNECT_MS   15000
+
+void mergeScanResults(int n) {
+    String sel = (scanSelectedIdx < scanCount) ? scanResults[scanSelectedIdx].ssid : "";
+    for (int i = 0; i < n; i++) {
         String ssid = WiFi.SSID(i);
         if (ssid.length() == 0) continue;  // skip hidden
         // Deduplicate — keep strongest signal per SSID
@@ -458,63 +1591,383 @@ void startWifiScan() {
                 break;
             }
         }
-        if (!dup) {
-            scanResults[scanCount].ssid = ssid;
-            scanResults[scanCount].rssi = WiFi.RSSI(i);
-            scanResults[scanCount].open = (WiFi.encryptionType(i) == WIFI_AUTH_OPEN);
+        if (dup) continue;
+        int slot = scanCount;
+        if (scanCount == MAX_SCAN_RESULTS) {   // full: replace the weakest
+            if (WiFi.RSSI(i) <= scanResults[scanCount - 1].rssi) continue;
+            slot = scanCount - 1;
+        } else {
             scanCount++;
         }
+        scanResults[slot].ssid = ssid;
+        scanResults[slot].rssi = WiFi.RSSI(i);
+        scanResults[slot].open = (WiFi.encryptionType(i) == WIFI_AUTH_OPEN);
     }
-    WiFi.scanDelete();
 
     // Sort by signal strength (strongest first)
     std::sort(scanResults, scanResults + scanCount,
         [](const ScanResult &a, const ScanResult &b) { return a.rssi > b.rssi; });
+
+    // Keep the highlighted network under the cursor as results stream in
+    for (int j = 0; j < scanCount; j++)
+        if (sel.length() && scanResults[j].ssid == sel) scanSelectedIdx = j;
+    if (scanSelectedIdx < scanScrollOff) scanScrollOff = scanSelectedIdx;
+    if (scanSelectedIdx >= scanScrollOff + (int)VISIBLE_LINES)
+        scanScrollOff = scanSelectedIdx - VISIBLE_LINES + 1;
 }
 
-bool tryWifiConnect(const String &ssid, const String &pass, int timeoutSec = 15) {
-    WiFi.disconnect();
-    delay(100);
+void stopWifiScan() {
+    if (scanChannel == 0) return;
+    esp_wifi_scan_stop();
+    WiFi.scanDelete();
+    scanChannel = 0;
+}
+
+void startWifiScan() {
+    stopWifiScan();
+    scanCount = 0;
+    scanSelectedIdx = 0;
+    scanScrollOff   = 0;
+    wifiError = "";
+
     WiFi.mode(WIFI_STA);
-    if (pass.length() > 0)
-        WiFi.begin(ssid.c_str(), pass.c_str());
+    // A pending connect attempt blocks scanning; a live connection does not
+    if (WiFi.status() != WL_CONNECTED) {
+        WiFi.disconnect();
+        wifiBeginMs  = 0;   // abandon the attempt (and its fast-path fallback)
+        wifiFastTry  = false;
+        wifiRoamJoin = false;
+    }
+    scanChannel = 1;
+    scanStartMs = millis();
+    WiFi.scanNetworks(true, false, false, WIFI_SCAN_CH_MS, scanChannel);
+}
+
+// Called every loop(): collect the finished channel and start the next
+void serviceWifiScan() {
+    if (scanChannel == 0) return;
+    int16_t n = WiFi.scanComplete();
+    if (n == WIFI_SCAN_RUNNING) return;
+    if (n > 0) mergeScanResults(n);
+    WiFi.scanDelete();
+    if (++scanChannel > WIFI_SCAN_LAST_CH) {
+        scanChannel = 0;
+        Serial.printf("[WIFI] Scan found %d networks in %lu ms\n", scanCount,
+                      millis() - scanStartMs);
+        return;
+    }
+    WiFi.scanNetworks(true, false, false, WIFI_SCAN_CH_MS, scanChannel);
+}
+
+// Runs on the WiFi event task: only record what happened
+void onWifiEvent(arduino_event_id_t ev, arduino_event_info_t info) {
+    if (ev == ARDUINO_EVENT_WIFI_STA_GOT_IP)
+        wifiGotIP = true;
+    else if (ev == ARDUINO_EVENT_WIFI_STA_DISCONNECTED)
+        wifiDiscReason = info.wifi_sta_disconnected.reason;
+}
+
+bool loadWifiFast();
+void saveWifiFast();
+void loadSavedNets();
+void saveWifiCreds(const String &ssid, const String &pass);
+
+// Start associating. With fast set and a cached AP for this SSID, connect
+// straight to its BSSID/channel (and, with WIFI_REUSE_IP, the old lease)
+// so neither the scan nor DHCP runs; serviceWifiFast() falls back. An
+// explicit bssid/chan (roaming) is tried the same way, without the lease.
+void wifiBegin(const String &ssid, const String &pass, bool fast,
+               const uint8_t *bssid = nullptr, int chan = 0) {
+    bool cached = !bssid && fast && loadWifiFast() && wifiFast.ssid == ssid;
+    if (cached) {
+        bssid = wifiFast.bssid;
+        chan  = wifiFast.chan;
+    }
+    wifiFastTry = bssid != nullptr;
+    if (cached && WIFI_REUSE_IP && wifiFast.ip) {
+        WiFi.config(IPAddress(wifiFast.ip), IPAddress(wifiFast.gw),
+                    IPAddress(wifiFast.mask), IPAddress(wifiFast.dns));
+        wifiStaticIp = true;
+    } else if (wifiStaticIp) {
+        WiFi.config(IPAddress(), IPAddress(), IPAddress());  // back to DHCP
+        wifiStaticIp = false;
+    }
+    const char *pw = pass.length() > 0 ? pass.c_str() : nullptr;
+    if (wifiFastTry)
+        WiFi.begin(ssid.c_str(), pw, chan, bssid);
     else
-        WiFi.begin(ssid.c_str());
+        WiFi.begin(ssid.c_str(), pw);
+    wifiBeginSSID = ssid;
+    wifiBeginPass = pass;
+    wifiBeginMs   = millis();
+    Serial.printf("[WIFI] Begin %s via %s\n", ssid.c_str(),
+                  wifiFastTry ? "cached AP" : "full scan");
+}
 
-    for (int i = 0; i < timeoutSec * 2; i++) {
-        if (WiFi.status() == WL_CONNECTED) {
-            Serial.printf("[WIFI] Connected to %s\n", ssid.c_str());
-            return true;
+// Called every loop(): time the connect, remember the AP, fall back from
+// a cached AP that is gone or silent after WIFI_FAST_MS
+void serviceWifiFast() {
+    if (!wifiBeginMs) return;
+    if (WiFi.status() == WL_CONNECTED) {
+        Serial.printf("[WIFI] Online in %lu ms via %s, ch %d\n", millis() - wifiBeginMs,
+                      wifiFastTry ? "cached AP" : "full scan", (int)WiFi.channel());
+        if (!tWifiUp) { tWifiUp = millis(); bootMark("wifi up"); }
+        wifiBeginMs = 0;
+        wifiFastTry = false;
+        saveWifiFast();
+        if (wifiRoamJoin) {   // the roamed-to network is now the last used
+            wifiRoamJoin = false;
+            saveWifiCreds(wifiBeginSSID, wifiBeginPass);
+        }
+        return;
+    }
+    if (!wifiFastTry) return;
+    if (millis() - wifiBeginMs < WIFI_FAST_MS && wifiDiscReason != WIFI_REASON_NO_AP_FOUND)
+        return;
+    Serial.printf("[WIFI] Cached AP failed after %lu ms, scanning\n", millis() - wifiBeginMs);
+    WiFi.disconnect();
+    wifiDiscReason = 0;
+    wifiBegin(wifiBeginSSID, wifiBeginPass, false);
+}
+
+// ── Roaming: move to a stronger saved AP before the signal drops out ──
+// While streaming, a weak RSSI (below WIFI_ROAM_RSSI for 3 checks) starts
+// a sweep of single-channel async scans (WIFI_SCAN_CH_MS each, like the
+// setup scan). The radio is back on the home channel between steps, and
+// each step starts only while the stream buffer holds ROAM_COVER_MS of
+// audio, so the time off channel cannot starve the decoder. The best
+// saved AP at least WIFI_ROAM_GAIN dB stronger is then joined directly;
+// the audio link reconnects in the background while buffered audio plays.
+#define WIFI_ROAM_GAIN   8
+#define WIFI_ROAM_EVERY  60000
+#define ROAM_COVER_MS    (WIFI_SCAN_CH_MS * 3)
+
+struct RoamBest {
+    int     net;        // savedNets index, -1 = none yet
+    int     rssi;
+    int     chan;
+    uint8_t bssid[6];
+};
+RoamBest roamBest;
+int      roamCh = 0;    // channel being scanned, 0 = no sweep
+
+// Keep the strongest saved AP (other than the current one) from a scan
+void roamCollect(int n) {
+    uint8_t *curB = WiFi.BSSID();
+    for (int i = 0; i < n; i++) {
+        if (WiFi.RSSI(i) < roamBest.rssi || !memcmp(WiFi.BSSID(i), curB, 6)) continue;
+        for (int k = 0; k < savedNetCount; k++) {
+            if (WiFi.SSID(i) != savedNets[k].ssid) continue;
+            roamBest.net  = k;
+            roamBest.rssi = WiFi.RSSI(i);
+            roamBest.chan = WiFi.channel(i);
+            memcpy(roamBest.bssid, WiFi.BSSID(i), 6);
         }
-        delay(500);
-        // Show connecting animation
-        canvas.fillSprite(C_BG);
-        canvas.setTextDatum(MC_DATUM);
-        canvas.setFont(&fonts::FreeSansBold9pt7b);
-        canvas.setTextColor(C_ACCENT);
-        canvas.drawString("SOMA FM", SCREEN_W / 2, 40);
-        canvas.setFont(&fonts::Font2);
-        canvas.setTextColor(C_WHITE);
-        canvas.drawString("Connecting...", SCREEN_W / 2, 65);
-        canvas.setTextColor(C_GRAY);
-        canvas.drawString(ssid, SCREEN_W / 2, 85);
-        String dots = "";
-        for (int d = 0; d <= (i % 3); d++) dots += " .";
-        canvas.setTextColor(C_DARKGRAY);
-        canvas.drawString(dots, SCREEN_W / 2, 105);
-        canvas.pushSprite(0, 0);
     }
+}
 
+void roamJoin() {
+    int cur = WiFi.RSSI();
+    if (roamBest.net < 0) {
+        Serial.printf("[ROAM] No saved AP above %d dBm\n", cur + WIFI_ROAM_GAIN);
+        return;
+    }
+    const uint8_t *b = roamBest.bssid;
+    const SavedNet &net = savedNets[roamBest.net];
+    Serial.printf("[ROAM] %d dBm -> %s %02x:%02x:%02x:%02x:%02x:%02x ch %d (%d dBm), buffer %u B\n",
+                  cur, net.ssid.c_str(), b[0], b[1], b[2], b[3], b[4], b[5],
+                  roamBest.chan, roamBest.rssi, aBufFill);
+    uint8_t bssid[6];
+    memcpy(bssid, b, 6);
     WiFi.disconnect();
-    Serial.printf("[WIFI] Failed to connect to %s\n", ssid.c_str());
-    return false;
+    wifiBegin(net.ssid, net.pass, false, bssid, roamBest.chan);
+    wifiRoamJoin = true;
+}
+
+void serviceWifiRoam() {
+    static unsigned long tCheck = 0, tScan = 0;
+    static int  weak     = 0;
+    static bool scanning = false;
+    uint32_t cover = (uint32_t)STREAM_BITRATE * 125 * ROAM_COVER_MS / 1000;
+    if (scanning) {
+        int16_t n = WiFi.scanComplete();
+        if (n == WIFI_SCAN_RUNNING) return;
+        scanning = false;
+        if (n > 0 && WiFi.status() == WL_CONNECTED) roamCollect(n);
+        WiFi.scanDelete();
+        if (++roamCh > WIFI_SCAN_LAST_CH) {
+            roamCh = 0;
+            if (WiFi.status() == WL_CONNECTED) roamJoin();
+        }
+        return;
+    }
+    if (roamCh) {
+        // Next channel once the buffer has refilled; give up if playback
+        // stopped or the link went away
+        if (!aRunning || aPaused || WiFi.status() != WL_CONNECTED || scanChannel) {
+            roamCh = 0;
+            return;
+        }
+        if (aBufFill < cover) return;
+        scanning = true;
+        WiFi.scanNetworks(true, false, false, WIFI_SCAN_CH_MS, roamCh);
+        return;
+    }
+    if (!aRunning || aPaused || WiFi.status() != WL_CONNECTED || scanChannel ||
+        wifiBeginMs || millis() - tCheck < 2000) return;
+    tCheck = millis();
+    weak = (WiFi.RSSI() < WIFI_ROAM_RSSI) ? weak + 1 : 0;
+    if (weak < 3 || (tScan && millis() - tScan < WIFI_ROAM_EVERY)) return;
+    if (savedNetCount < 0) loadSavedNets();   // kept current in RAM after this
+    if (aBufFill < cover) return;
+    tScan = millis();
+    roamBest = {-1, WiFi.RSSI() + WIFI_ROAM_GAIN, 0, {}};
+    roamCh   = 1;
+    Serial.printf("[ROAM] RSSI %d dBm, looking for a stronger AP\n", (int)WiFi.RSSI());
+}
+
+// Begin connecting and switch to STATE_WIFI_CONNECT. save: credentials
+// typed by the user (stored on success, failure returns to their screen);
+// otherwise stored credentials, and failure opens WiFi setup.
+void wifiAttempt(const String &ssid, const String &pass, bool fast) {
+    wifiConnSSID   = ssid;
+    wifiConnPass   = pass;
+    wifiGotIP      = false;
+    wifiDiscReason = 0;
+    wifiRoamJoin   = false;
+    WiFi.disconnect();
+    WiFi.mode(WIFI_STA);
+    wifiBegin(ssid, pass, fast);
+    wifiConnStart = millis();
+    Serial.printf("[WIFI] Connecting to %s\n", ssid.c_str());
+}
+
+void startWifiConnect(const String &ssid, const String &pass, bool save, AppState onOk) {
+    stopWifiScan();
+    wifiConnSave  = save;
+    wifiConnOk    = onOk;
+    wifiConnPrev  = appState;
+    wifiAutoRanked = true;   // a single network, nothing to fall back to
+    appState = STATE_WIFI_CONNECT;
+    wifiAttempt(ssid, pass, !save);
+}
+
+// Connect with the saved networks: the last-used one first (cached AP
+// fast path), then, if that fails, the others that a scan can see,
+// strongest first. skipLast: the last-used one already failed.
+void startWifiAuto(AppState onOk, bool skipLast = false) {
+    loadSavedNets();
+    stopWifiScan();
+    wifiConnSave   = false;
+    wifiConnOk     = onOk;
+    wifiConnPrev   = appState;
+    wifiAutoCount  = wifiAutoNext = 0;
+    wifiAutoRanked = savedNetCount <= 1 && !skipLast;
+    wifiAutoScan   = false;
+    appState = STATE_WIFI_CONNECT;
+    wifiConnSSID = savedNets[0].ssid;
+    if (!skipLast) {
+        wifiAttempt(savedNets[0].ssid, savedNets[0].pass, true);
+    } else {
+        wifiConnStart = millis();
+        wifiAutoRanked = true;
+        wifiAutoScan   = true;
+        WiFi.disconnect();
+        WiFi.scanNetworks(true);
+    }
+}
+
+// Order the other saved networks by the RSSI seen in the n scan results
+void rankSavedNets(int n) {
+    int32_t best[WIFI_MAX_SAVED];
+    wifiAutoCount = wifiAutoNext = 0;
+    for (int k = 1; k < savedNetCount; k++) {
+        best[k] = -127;
+        for (int i = 0; i < n; i++)
+            if (WiFi.SSID(i) == savedNets[k].ssid) best[k] = max(best[k], WiFi.RSSI(i));
+        if (best[k] > -127) wifiAutoOrder[wifiAutoCount++] = k;
+    }
+    std::sort(wifiAutoOrder, wifiAutoOrder + wifiAutoCount,
+              [&](int a, int b) { return best[a] > best[b]; });
+    for (int i = 0; i < wifiAutoCount; i++)
+        Serial.printf("[WIFI] Saved %s: %d dBm\n", savedNets[wifiAutoOrder[i]].ssid.c_str(),
+                      (int)best[wifiAutoOrder[i]]);
+}
+
+// After a failed attempt: start the ranking scan or the next candidate
+bool wifiAutoAdvance() {
+    if (!wifiAutoRanked) {
+        Serial.printf("[WIFI] Scanning for %d other saved networks\n", savedNetCount - 1);
+        wifiAutoRanked = true;
+        wifiAutoScan   = true;
+        wifiConnStart  = millis();
+        WiFi.disconnect();
+        WiFi.scanNetworks(true);
+        return true;
+    }
+    if (wifiAutoNext >= wifiAutoCount) return false;
+    SavedNet &n = savedNets[wifiAutoOrder[wifiAutoNext++]];
+    wifiAttempt(n.ssid, n.pass, false);
+    return true;
+}
+
+bool startPlaying(int idx);
+void saveWifiCreds(const String &ssid, const String &pass);
+
+void endWifiConnect(const char *err) {
+    if (!err) {
+        Serial.printf("[WIFI] Connected to %s in %lu ms\n", wifiConnSSID.c_str(),
+                      millis() - wifiConnStart);
+        saveWifiCreds(wifiConnSSID, wifiConnPass);  // now the last-used network
+        appState = wifiConnOk;
+        if (wifiPendingPlay >= 0) {
+            int idx = wifiPendingPlay;
+            wifiPendingPlay = -1;
+            if (startPlaying(idx)) appState = STATE_PLAYING;
+        }
+        return;
+    }
+    Serial.printf("[WIFI] %s: %s\n", wifiConnSSID.c_str(), err);
+    if (!wifiConnSave && wifiAutoAdvance()) return;  // another saved network
+    WiFi.disconnect();
+    wifiPendingPlay = -1;
+    if (wifiConnSave) {
+        appState = wifiConnPrev;
+    } else {
+        startWifiScan();
+        appState = STATE_WIFI_SCAN;
+        err = "Saved network failed";
+    }
+    wifiError = err;
+    wifiErrorTime = millis();
+}
+
+void serviceWifiConnect() {
+    if (wifiAutoScan) {
+        int16_t n = WiFi.scanComplete();
+        if (n == WIFI_SCAN_RUNNING && millis() - wifiConnStart < WIFI_CONNECT_MS) return;
+        wifiAutoScan = false;
+        rankSavedNets(max((int16_t)0, n));
+        WiFi.scanDelete();
+        if (!wifiAutoAdvance()) endWifiConnect("No saved network in range");
+        return;
+    }
+    uint8_t r = wifiDiscReason;
+    if (wifiGotIP && WiFi.status() == WL_CONNECTED)
+        endWifiConnect(nullptr);
+    else if (r == WIFI_REASON_AUTH_FAIL || r == WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT ||
+             r == WIFI_REASON_HANDSHAKE_TIMEOUT)
+        endWifiConnect("Wrong password");
+    else if (millis() - wifiConnStart > WIFI_CONNECT_MS)
+        endWifiConnect(r == WIFI_REASON_NO_AP_FOUND ? "Network not found" : "Connection timed out");
 }
 
 // ═══════════════════════════════════════════════════════════
 //  SOMA FM API
 // ═══════════════════════════════════════════════════════════
-bool parseChannelsJson(Stream &input) {
-    DynamicJsonDocument filter(256);
+#define CHANNELS_DOC_SIZE 49152
+
+void channelsFilter(DynamicJsonDocument &filter) {
     JsonObject cf = filter["channels"].createNestedObject();
     cf["id"]          = true;
     cf["title"]       = true;
@@ -522,13 +1975,36 @@ bool parseChannelsJson(Stream &input) {
     cf["genre"]       = true;
     cf["image"]       = true;
     cf["listeners"]   = true;
+    JsonObject pf = cf.createNestedArray("playlists").createNestedObject();
+    pf["url"]         = true;
+    pf["format"]      = true;
+    pf["quality"]     = true;
+}
+
+// Playlist URL for STREAM_FORMAT, preferring the STREAM_QUALITY variant
+String pickPlaylist(JsonArray pls) {
+    String any = "";
+    for (JsonObject p : pls) {
+        if (p["format"].as<String>() != STREAM_FORMAT) continue;
+        if (p["quality"].as<String>() == STREAM_QUALITY) return p["url"].as<String>();
+        if (any.length() == 0) any = p["url"].as<String>();
+    }
+    return any;
+}
 
-    DynamicJsonDocument doc(32768);
+// Accepts a Stream (cache file) or a String (network payload)
+template <typename T>
+bool parseChannelsJson(T &input) {
+    DynamicJsonDocument filter(384);
+    channelsFilter(filter);
+
+    DynamicJsonDocument doc(CHANNELS_DOC_SIZE);
     DeserializationError err = deserializeJson(
         doc, input, DeserializationOption::Filter(filter));
 
     if (err) {
         Serial.printf("[PARSE] JSON error: %s\n", err.c_str());
+        errorMsg = String("JSON: ") + err.c_str();
         return false;
     }
 
@@ -542,9 +2018,12 @@ bool parseChannelsJson(Stream &input) {
         s.desc      = o["description"].as<String>();
         s.genre     = o["genre"].as<String>();
         s.imageUrl  = o["image"].as<String>();
+        s.plsUrl    = pickPlaylist(o["playlists"]);
         s.listeners = o["listeners"].as<String>().toInt();
         s.color     = getGenreColor(s.genre);
         s.fav       = false;
+        s.rowKey    = ++rowKeyNext;
+        s.thumb     = -2;
         stationCount++;
     }
     Serial.printf("[PARSE] Loaded %d stations\n", stationCount);
@@ -563,15 +2042,16 @@ bool loadCachedChannels() {
 
 bool fetchChannels(bool showSplash = true) {
     if (showSplash) {
-        canvas.fillSprite(C_BG);
-        canvas.setTextDatum(MC_DATUM);
-        canvas.setFont(&fonts::FreeSansBold9pt7b);
-        canvas.setTextColor(C_ACCENT);
-        canvas.drawString("SOMA FM", SCREEN_W / 2, 40);
-        canvas.setFont(&fonts::Font2);
-        canvas.setTextColor(C_WHITE);
-        canvas.drawString("Loading stations...", SCREEN_W / 2, 75);
-        canvas.pushSprite(0, 0);
+        renderFrame([] {
+            canvas.fillSprite(C_BG);
+            canvas.setTextDatum(MC_DATUM);
+            canvas.setFont(&fonts::FreeSansBold9pt7b);
+            canvas.setTextColor(C_ACCENT);
+            canvas.drawString("SOMA FM", SCREEN_W / 2, 40);
+            canvas.setFont(&fonts::Font2);
+            canvas.setTextColor(C_WHITE);
+            canvas.drawString("Loading stations...", SCREEN_W / 2, 75);
+        });
     }
 
     Serial.printf("[FETCH] Free heap: %u\n", ESP.getFreeHeap());
@@ -609,51 +2089,19 @@ bool fetchChannels(bool showSplash = true) {
     String payload = http.getString();
     http.end();
 
-    // Save to flash cache
+    // Save to flash cache, then parse from the file so the payload and the
+    // JSON document never have to fit in RAM at the same time
     File f = LittleFS.open("/channels.json", "w");
     if (f) {
-        f.print(payload);
+        size_t saved = f.print(payload);
         f.close();
-        Serial.printf("[CACHE] Saved channels.json (%d bytes)\n", payload.length());
-    }
-
-    // Parse from the saved string
-    // ArduinoJson can deserialize from a const char*
-    DynamicJsonDocument filter(256);
-    JsonObject cf = filter["channels"].createNestedObject();
-    cf["id"]          = true;
-    cf["title"]       = true;
-    cf["description"] = true;
-    cf["genre"]       = true;
-    cf["image"]       = true;
-    cf["listeners"]   = true;
-
-    DynamicJsonDocument doc(32768);
-    DeserializationError err = deserializeJson(
-        doc, payload, DeserializationOption::Filter(filter));
-
-    if (err) {
-        errorMsg = String("JSON: ") + err.c_str();
-        return false;
-    }
-
-    JsonArray ch = doc["channels"];
-    stationCount = 0;
-    for (JsonObject o : ch) {
-        if (stationCount >= MAX_STATIONS) break;
-        Station &s  = stations[stationCount];
-        s.id        = o["id"].as<String>();
-        s.title     = o["title"].as<String>();
-        s.desc      = o["description"].as<String>();
-        s.genre     = o["genre"].as<String>();
-        s.imageUrl  = o["image"].as<String>();
-        s.listeners = o["listeners"].as<String>().toInt();
-        s.color     = getGenreColor(s.genre);
-        s.fav       = false;
-        stationCount++;
+        Serial.printf("[CACHE] Saved channels.json (%d bytes)\n", saved);
+        if (saved == payload.length()) {
+            payload = String();
+            return loadCachedChannels();
+        }
     }
-    Serial.printf("[FETCH] Loaded %d stations\n", stationCount);
-    return stationCount > 0;
+    return parseChannelsJson(payload);
 }
 
 // ═══════════════════════════════════════════════════════════
@@ -675,20 +2123,99 @@ String loadWifiPass() {
     return pass;
 }
 
+void loadSavedNets() {
+    if (savedNetCount >= 0) return;
+    prefs.begin("somafm", true);
+    savedNetCount = min((int)prefs.getUChar("nets", 0), WIFI_MAX_SAVED);
+    for (int i = 0; i < savedNetCount; i++) {
+        savedNets[i].ssid = prefs.getString((String("s") + i).c_str(), "");
+        savedNets[i].pass = prefs.getString((String("p") + i).c_str(), "");
+    }
+    String ssid = prefs.getString("ssid", "");
+    prefs.end();
+    // Single network saved by earlier firmware
+    if (savedNetCount == 0 && ssid.length() > 0) {
+        savedNets[0].ssid = ssid;
+        savedNets[0].pass = loadWifiPass();
+        savedNetCount = 1;
+    }
+}
+
+// Store as the last-used network: front of the list, and "ssid"/"pass"
 void saveWifiCreds(const String &ssid, const String &pass) {
+    loadSavedNets();
+    if (savedNetCount > 0 && savedNets[0].ssid == ssid && savedNets[0].pass == pass) return;
+    int at = 0;
+    while (at < savedNetCount && savedNets[at].ssid != ssid) at++;
+    if (at == WIFI_MAX_SAVED) at--;             // full: drop the least recent
+    else if (at == savedNetCount) savedNetCount++;
+    for (int i = at; i > 0; i--) savedNets[i] = savedNets[i - 1];
+    savedNets[0].ssid = ssid;
+    savedNets[0].pass = pass;
+
     prefs.begin("somafm", false);
     prefs.putString("ssid", ssid);
     prefs.putString("pass", pass);
+    prefs.putUChar("nets", savedNetCount);
+    for (int i = 0; i < savedNetCount; i++) {
+        prefs.putString((String("s") + i).c_str(), savedNets[i].ssid);
+        prefs.putString((String("p") + i).c_str(), savedNets[i].pass);
+    }
+    prefs.end();
+    Serial.printf("[WIFI] Saved creds for: %s (%d networks)\n", ssid.c_str(), savedNetCount);
+}
+
+bool loadWifiFast() {
+    if (wifiFast.ssid.length() == 0) {
+        prefs.begin("somafm", true);
+        wifiFast.ssid = prefs.getString("fssid", "");
+        prefs.getBytes("fbssid", wifiFast.bssid, 6);
+        wifiFast.chan = prefs.getUChar("fchan", 0);
+        wifiFast.ip   = prefs.getUInt("fip", 0);
+        wifiFast.gw   = prefs.getUInt("fgw", 0);
+        wifiFast.mask = prefs.getUInt("fmask", 0);
+        wifiFast.dns  = prefs.getUInt("fdns", 0);
+        prefs.end();
+    }
+    return wifiFast.ssid.length() > 0 && wifiFast.chan > 0;
+}
+
+// Remember the AP and lease just connected to (written only when changed)
+void saveWifiFast() {
+    loadWifiFast();
+    WifiFastCache c = {};
+    c.ssid = WiFi.SSID();
+    memcpy(c.bssid, WiFi.BSSID(), 6);
+    c.chan = WiFi.channel();
+    c.ip   = WiFi.localIP();
+    c.gw   = WiFi.gatewayIP();
+    c.mask = WiFi.subnetMask();
+    c.dns  = WiFi.dnsIP();
+    if (c.ssid == wifiFast.ssid && !memcmp(c.bssid, wifiFast.bssid, 6) &&
+        c.chan == wifiFast.chan && c.ip == wifiFast.ip && c.gw == wifiFast.gw) return;
+    prefs.begin("somafm", false);
+    prefs.putString("fssid", c.ssid);
+    prefs.putBytes("fbssid", c.bssid, 6);
+    prefs.putUChar("fchan", c.chan);
+    prefs.putUInt("fip", c.ip);
+    prefs.putUInt("fgw", c.gw);
+    prefs.putUInt("fmask", c.mask);
+    prefs.putUInt("fdns", c.dns);
     prefs.end();
-    Serial.printf("[WIFI] Saved creds for: %s\n", ssid.c_str());
+    wifiFast = c;
+    Serial.printf("[WIFI] Cached AP %02x:%02x:%02x:%02x:%02x:%02x ch %d\n", c.bssid[0],
+                  c.bssid[1], c.bssid[2], c.bssid[3], c.bssid[4], c.bssid[5], c.chan);
 }
 
 void loadFavorites() {
     prefs.begin("somafm", true);
     String favs = prefs.getString("favs", "");
     prefs.end();
-    for (int i = 0; i < stationCount; i++)
-        stations[i].fav = (favs.indexOf(stations[i].id) >= 0);
+    for (int i = 0; i < stationCount; i++) {
+        bool fav = favs.indexOf(stations[i].id) >= 0;
+        if (fav != stations[i].fav) stations[i].rowKey = ++rowKeyNext;
+        stations[i].fav = fav;
+    }
     Serial.printf("[FAV] Loaded: %s\n", favs.c_str());
 }
 
@@ -709,6 +2236,7 @@ void saveLastStation() {
     if (selectedIdx >= 0 && selectedIdx < stationCount) {
         prefs.begin("somafm", false);
         prefs.putString("last", stations[selectedIdx].id);
+        prefs.putString("lastpls", stations[selectedIdx].plsUrl);
         prefs.end();
     }
 }
@@ -755,6 +2283,7 @@ void sortStations() {
 void toggleFavorite(int idx) {
     if (idx < 0 || idx >= stationCount) return;
     stations[idx].fav = !stations[idx].fav;
+    stations[idx].rowKey = ++rowKeyNext;
     saveFavorites();
     sortStations();
 }
@@ -789,8 +2318,11 @@ void freeLogo() {
     logoDataLen = 0;
     logoForIdx  = -1;
     logoValid   = false;
+    logoLayerFor = -1;
 }
 
+void thumbQueue(int stationIdx);
+
 String logoCachePath(int stationIdx) {
     return "/logos/" + stations[stationIdx].id + ".img";
 }
@@ -824,6 +2356,7 @@ void saveCachedLogo(int stationIdx) {
         f.write(logoData, logoDataLen);
         f.close();
         Serial.printf("[LOGO] Cached: %s (%d bytes)\n", path.c_str(), logoDataLen);
+        thumbQueue(stationIdx);
     }
 }
 
@@ -888,13 +2421,197 @@ void downloadLogo(int stationIdx) {
     }
 }
 
+// ═══════════════════════════════════════════════════════════
+//  THUMBNAIL ATLAS
+// ═══════════════════════════════════════════════════════════
+// Browser rows show THUMB_SZ logo thumbnails from one LittleFS file: an
+// 8-byte header, then fixed-size slots of {station id, RGB565 pixels}.
+// thumbTask (Core 1, priority 0, so it only runs while loop() sleeps)
+// decodes cached logos into new slots; the UI only looks ids up in the
+// in-RAM index and pages a slot's pixels into a small cache per visible
+// row. Scrolling never decodes an image or touches the network.
+#define THUMB_SZ     (LINE_H - 2)
+#define THUMB_PX     (THUMB_SZ * THUMB_SZ)
+#define THUMB_MAX    (MAX_STATIONS * 2)
+#define THUMB_ID_LEN 24
+#define THUMB_PATH   "/logos/thumbs.bin"
+#define THUMB_HDR    8
+#define THUMB_SLOT   (THUMB_ID_LEN + THUMB_PX * 2)
+#define THUMB_MIN_HEAP 60000   // decode only with this much free heap
+
+struct ThumbJob { char id[THUMB_ID_LEN]; bool jpg; };
+QueueHandle_t thumbQ = nullptr;
+char          thumbIds[THUMB_MAX][THUMB_ID_LEN];
+volatile int  thumbN   = 0;     // slots in the atlas (index entries valid)
+volatile uint32_t thumbSeq = 0; // bumped per new slot, for the UI
+portMUX_TYPE  thumbMux = portMUX_INITIALIZER_UNLOCKED;
+
+// UI side: pages of slot pixels, recycled least-recently-used
+struct ThumbPage {
+    int      slot = -1;
+    uint32_t used = 0;
+    uint16_t px[THUMB_PX];
+};
+ThumbPage thumbPage[VISIBLE_LINES + 4];
+uint32_t  thumbTick = 0;
+File      thumbRd;
+uint32_t  thumbRdSeq = 0;
+
+void thumbQueue(int stationIdx) {
+    if (!thumbQ || stationIdx < 0 || stationIdx >= stationCount) return;
+    const Station &st = stations[stationIdx];
+    if (st.thumb >= 0 || st.id.length() >= THUMB_ID_LEN) return;
+    ThumbJob job;
+    strlcpy(job.id, st.id.c_str(), sizeof(job.id));
+    job.jpg = st.imageUrl.endsWith(".jpg") || st.imageUrl.endsWith(".jpeg");
+    xQueueSend(thumbQ, &job, 0);
+}
+
+// Every station without a thumbnail (after the channel list (re)loads)
+void thumbPlan() {
+    for (int i = 0; i < stationCount; i++) thumbQueue(i);
+}
+
+int thumbFind(const char *id) {
+    int n;
+    portENTER_CRITICAL(&thumbMux);
+    n = thumbN;
+    portEXIT_CRITICAL(&thumbMux);
+    for (int i = 0; i < n; i++)
+        if (!strcmp(thumbIds[i], id)) return i;
+    return -1;
+}
+
+// Pixels of a station's thumbnail, or nullptr (none yet / read failed)
+const uint16_t *thumbFor(int idx) {
+    static uint32_t seen = 0;
+    if (seen != thumbSeq) {
+        seen = thumbSeq;   // new slots: look up the stations that had none
+        for (int i = 0; i < stationCount; i++)
+            if (stations[i].thumb == -1) stations[i].thumb = -2;
+    }
+    Station &st = stations[idx];
+    if (st.thumb == -2) st.thumb = thumbFind(st.id.c_str());
+    if (st.thumb < 0) return nullptr;
+
+    ThumbPage *lru = &thumbPage[0];
+    for (auto &p : thumbPage) {
+        if (p.slot == st.thumb) {
+            p.used = ++thumbTick;
+            return p.px;
+        }
+        if (p.used < lru->used) lru = &p;
+    }
+    // Reopen after the task appended slots so the reader sees them
+    if (thumbRd && thumbRdSeq != thumbSeq) thumbRd.close();
+    if (!thumbRd) {
+        thumbRd    = LittleFS.open(THUMB_PATH, "r");
+        thumbRdSeq = thumbSeq;
+    }
+    lru->slot = -1;
+    if (!thumbRd || !thumbRd.seek(THUMB_HDR + st.thumb * THUMB_SLOT + THUMB_ID_LEN) ||
+        thumbRd.read((uint8_t *)lru->px, THUMB_PX * 2) != THUMB_PX * 2) {
+        st.thumb = -1;
+        return nullptr;
+    }
+    lru->slot = st.thumb;
+    lru->used = ++thumbTick;
+    return lru->px;
+}
+
+// Task side: read the slot ids of an existing atlas, or start a new one
+bool thumbOpenAtlas() {
+    File f = LittleFS.open(THUMB_PATH, "r");
+    uint8_t hdr[THUMB_HDR];
+    if (f && f.read(hdr, THUMB_HDR) == THUMB_HDR && !memcmp(hdr, "THB1", 4) &&
+        hdr[4] == THUMB_SZ) {
+        int n = min((int)((f.size() - THUMB_HDR) / THUMB_SLOT), THUMB_MAX);
+        for (int i = 0; i < n; i++) {
+            f.seek(THUMB_HDR + i * THUMB_SLOT);
+            f.read((uint8_t *)thumbIds[i], THUMB_ID_LEN);
+            thumbIds[i][THUMB_ID_LEN - 1] = 0;
+        }
+        f.close();
+        portENTER_CRITICAL(&thumbMux);
+        thumbN = n;
+        portEXIT_CRITICAL(&thumbMux);
+        Serial.printf("[THUMB] Atlas: %d thumbnails\n", n);
+        return true;
+    }
+    if (f) f.close();
+    f = LittleFS.open(THUMB_PATH, "w");
+    if (!f) return false;
+    memset(hdr, 0, sizeof(hdr));
+    memcpy(hdr, "THB1", 4);
+    hdr[4] = THUMB_SZ;
+    f.write(hdr, THUMB_HDR);
+    f.close();
+    Serial.println("[THUMB] New atlas");
+    return true;
+}
+
+void thumbTask(void *) {
+    if (!thumbOpenAtlas()) {
+        Serial.println("[THUMB] Atlas unavailable");
+        vTaskDelete(nullptr);
+        return;
+    }
+    M5Canvas spr;
+    spr.setColorDepth(16);
+    ThumbJob job;
+    while (true) {
+        xQueueReceive(thumbQ, &job, portMAX_DELAY);
+        if (thumbFind(job.id) >= 0 || thumbN >= THUMB_MAX) continue;
+        File f = LittleFS.open(String("/logos/") + job.id + ".img", "r");
+        if (!f) continue;   // queued again once the logo is cached
+        int len = f.size();
+        while (ESP.getFreeHeap() < THUMB_MIN_HEAP + (uint32_t)len) vTaskDelay(pdMS_TO_TICKS(5000));
+        uint8_t *data = len > 0 && len <= 25000 ? (uint8_t *)malloc(len) : nullptr;
+        bool ok = data && f.readBytes((char *)data, len) == (size_t)len;
+        f.close();
+        if (ok && (spr.getBuffer() || spr.createSprite(THUMB_SZ, THUMB_SZ))) {
+            uint32_t t = millis();
+            float sc = (float)THUMB_SZ / 120.0f;  // SOMA FM logos are 120x120
+            spr.fillSprite(C_BG);
+            ok = job.jpg ? spr.drawJpg(data, len, 0, 0, THUMB_SZ, THUMB_SZ, 0, 0, sc, sc)
+                         : spr.drawPng(data, len, 0, 0, THUMB_SZ, THUMB_SZ, 0, 0, sc, sc);
+            char id[THUMB_ID_LEN] = {};
+            strlcpy(id, job.id, sizeof(id));
+            File a = ok ? LittleFS.open(THUMB_PATH, "a") : File();
+            if (a) {
+                bool wr = a.write((const uint8_t *)id, THUMB_ID_LEN) == THUMB_ID_LEN &&
+                          a.write((const uint8_t *)spr.getBuffer(), THUMB_PX * 2) == THUMB_PX * 2;
+                a.close();
+                if (!wr) {
+                    // A partial slot would shift every later one: start over
+                    Serial.println("[THUMB] Atlas write failed, removing it");
+                    LittleFS.remove(THUMB_PATH);
+                    free(data);
+                    vTaskDelete(nullptr);
+                    return;
+                }
+            }
+            if (ok && a) {
+                memcpy(thumbIds[thumbN], id, THUMB_ID_LEN);
+                portENTER_CRITICAL(&thumbMux);
+                thumbN = thumbN + 1;
+                thumbSeq = thumbSeq + 1;
+                portEXIT_CRITICAL(&thumbMux);
+                Serial.printf("[THUMB] %s in %u ms (%d in atlas)\n", job.id,
+                              millis() - t, thumbN);
+            }
+        }
+        free(data);
+    }
+}
+
 // ═══════════════════════════════════════════════════════════
 //  UI COMPONENTS
 // ═══════════════════════════════════════════════════════════
 void drawBattery(int x, int y) {
     int bw = 18, bh = 10, nub = 2;
-    int level = M5.Power.getBatteryLevel();  // 0-100
-    bool charging = M5.Power.isCharging();
+    int level = frame.batt;  // 0-100
+    bool charging = frame.charging;
     // Body outline
     canvas.drawRect(x, y, bw, bh, C_GRAY);
     // Nub on right
@@ -924,65 +2641,83 @@ void drawHeader(const char *title, const char *right = nullptr) {
 }
 
 // Draw a small 5px triangle arrow at (cx,cy) center
-void drawArrow(int cx, int cy, int dir, uint16_t col) {
+void drawArrow(M5Canvas &c, int cx, int cy, int dir, uint16_t col) {
     // dir: 0=up, 1=down, 2=left, 3=right
     int s = 3; // half-size
     switch (dir) {
-        case 0: canvas.fillTriangle(cx, cy-s, cx-s, cy+s, cx+s, cy+s, col); break;
-        case 1: canvas.fillTriangle(cx, cy+s, cx-s, cy-s, cx+s, cy-s, col); break;
-        case 2: canvas.fillTriangle(cx-s, cy, cx+s, cy-s, cx+s, cy+s, col); break;
-        case 3: canvas.fillTriangle(cx+s, cy, cx-s, cy-s, cx-s, cy+s, col); break;
+        case 0: c.fillTriangle(cx, cy-s, cx-s, cy+s, cx+s, cy+s, col); break;
+        case 1: c.fillTriangle(cx, cy+s, cx-s, cy-s, cx+s, cy-s, col); break;
+        case 2: c.fillTriangle(cx-s, cy, cx+s, cy-s, cx+s, cy+s, col); break;
+        case 3: c.fillTriangle(cx+s, cy, cx-s, cy-s, cx-s, cy+s, col); break;
     }
 }
 
-void drawFooterBrowser() {
-    int y = SCREEN_H - FOOTER_H;
+void renderFooterBrowser(M5Canvas &c, int y) {
     int cy = y + FOOTER_H / 2 + 1;
-    canvas.fillRect(0, y, SCREEN_W, FOOTER_H, C_BG_DARK);
-    canvas.drawFastHLine(0, y, SCREEN_W, C_DARKGRAY);
-    canvas.setFont(&fonts::Font0);
-    canvas.setTextColor(C_GRAY);
-    canvas.setTextDatum(ML_DATUM);
+    c.fillRect(0, y, SCREEN_W, FOOTER_H, C_BG_DARK);
+    c.drawFastHLine(0, y, SCREEN_W, C_DARKGRAY);
+    c.setFont(&fonts::Font0);
+    c.setTextColor(C_GRAY);
+    c.setTextDatum(ML_DATUM);
     // up/down :Nav
     int x = 4;
-    drawArrow(x + 2, cy, 0, C_GRAY); drawArrow(x + 10, cy, 1, C_GRAY);
-    canvas.drawString(":Nav", x + 16, cy);
+    drawArrow(c, x + 2, cy, 0, C_GRAY); drawArrow(c, x + 10, cy, 1, C_GRAY);
+    c.drawString(":Nav", x + 16, cy);
     // Enter:Play
     x = 60;
-    canvas.drawString("Enter:Play", x, cy);
+    c.drawString("Enter:Play", x, cy);
     // f:Fav
     x = 144;
-    canvas.drawString("f:Fav", x, cy);
+    c.drawString("f:Fav", x, cy);
     // left/right :Vol
     x = 186;
-    drawArrow(x + 2, cy, 2, C_GRAY); drawArrow(x + 12, cy, 3, C_GRAY);
-    canvas.drawString(":Vol", x + 18, cy);
+    drawArrow(c, x + 2, cy, 2, C_GRAY); drawArrow(c, x + 12, cy, 3, C_GRAY);
+    c.drawString(":Vol", x + 18, cy);
 }
 
-void drawFooterPlayer() {
-    int y = SCREEN_H - FOOTER_H;
+void renderFooterPlayer(M5Canvas &c, int y) {
     int cy = y + FOOTER_H / 2 + 1;
-    canvas.fillRect(0, y, SCREEN_W, FOOTER_H, C_BG_DARK);
-    canvas.drawFastHLine(0, y, SCREEN_W, C_DARKGRAY);
-    canvas.setFont(&fonts::Font0);
-    canvas.setTextColor(C_GRAY);
-    canvas.setTextDatum(ML_DATUM);
+    c.fillRect(0, y, SCREEN_W, FOOTER_H, C_BG_DARK);
+    c.drawFastHLine(0, y, SCREEN_W, C_DARKGRAY);
+    c.setFont(&fonts::Font0);
+    c.setTextColor(C_GRAY);
+    c.setTextDatum(ML_DATUM);
     // BS:Back
     int x = 4;
-    canvas.drawString("BS:Back", x, cy);
+    c.drawString("BS:Back", x, cy);
     // left/right :Vol
     x = 62;
-    drawArrow(x + 2, cy, 2, C_GRAY); drawArrow(x + 12, cy, 3, C_GRAY);
-    canvas.drawString(":Vol", x + 18, cy);
+    drawArrow(c, x + 2, cy, 2, C_GRAY); drawArrow(c, x + 12, cy, 3, C_GRAY);
+    c.drawString(":Vol", x + 18, cy);
     // f:Fav
     x = 120;
-    canvas.drawString("f:Fav", x, cy);
+    c.drawString("f:Fav", x, cy);
     // up/down :Skip
     x = 160;
-    drawArrow(x + 2, cy, 0, C_GRAY); drawArrow(x + 10, cy, 1, C_GRAY);
-    canvas.drawString(":Skip", x + 16, cy);
+    drawArrow(c, x + 2, cy, 0, C_GRAY); drawArrow(c, x + 10, cy, 1, C_GRAY);
+    c.drawString(":Skip", x + 16, cy);
+}
+
+// Footer hints are static per screen: render into footerLayer once, then
+// just copy it (drawn directly if the sprite cannot be allocated)
+M5Canvas footerLayer;
+int      footerFor = -1;   // which renderer footerLayer holds
+
+void drawFooterLayer(int which, void (*render)(M5Canvas &, int)) {
+    if (footerFor != which) {
+        if (!footerLayer.getBuffer() && !footerLayer.createSprite(SCREEN_W, FOOTER_H)) {
+            render(canvas, SCREEN_H - FOOTER_H);
+            return;
+        }
+        render(footerLayer, 0);
+        footerFor = which;
+    }
+    footerLayer.pushSprite(&canvas, 0, SCREEN_H - FOOTER_H);
 }
 
+void drawFooterBrowser() { drawFooterLayer(0, renderFooterBrowser); }
+void drawFooterPlayer()  { drawFooterLayer(1, renderFooterPlayer); }
+
 void drawFooter(const char *text) {
     int y = SCREEN_H - FOOTER_H;
     canvas.fillRect(0, y, SCREEN_W, FOOTER_H, C_BG_DARK);
@@ -1004,7 +2739,7 @@ void drawEqBars(int x, int y, int w, int h) {
     // Mini EQ in header — driven by real audio data
     int bw = (w - 4) / 5;
     for (int i = 0; i < 5; i++) {
-        int bh = visBins[i * 3] * h / 255;
+        int bh = frame.bins[i * 3] * h / 255;
         if (bh < 1) bh = 1;
         uint16_t c = blendRGB(C_PLAYING, C_ACCENT, i * 50);
         canvas.fillRect(x + i * (bw + 1), y + h - bh, bw, bh, c);
@@ -1017,7 +2752,7 @@ void drawVisBars(int x, int y, int w, int h, uint16_t color) {
     int totalW = VIS_BINS * (bw + gap) - gap;
     int ox = x + (w - totalW) / 2;
     for (int i = 0; i < VIS_BINS; i++) {
-        int bh = visBins[i] * h / 255;
+        int bh = frame.bins[i] * h / 255;
         if (bh < 1) bh = 1;
         uint16_t c = blendRGB(color, C_ACCENT, i * 255 / VIS_BINS);
         canvas.fillRect(ox + i * (bw + gap), y + h - bh, bw, bh, c);
@@ -1026,12 +2761,12 @@ void drawVisBars(int x, int y, int w, int h, uint16_t color) {
 
 void drawVisWave(int x, int y, int w, int h, uint16_t color) {
     int mid = y + h / 2;
-    int r = visWaveW;  // read from current write position (oldest sample)
+    int r = frame.waveW;  // read from current write position (oldest sample)
     int step = max(1, VIS_WAVE_N / w);
     int prevY = mid;
     for (int px = 0; px < w; px++) {
         int idx = (r + px * step) % VIS_WAVE_N;
-        int sy = mid - (visWave[idx] * h / 256);
+        int sy = mid - (frame.wave[idx] * h / 256);
         sy = max(y, min(y + h - 1, sy));
         if (px > 0) {
             // Draw line between points
@@ -1045,9 +2780,11 @@ void drawVisWave(int x, int y, int w, int h, uint16_t color) {
 void drawVisVU(int x, int y, int w, int h, uint16_t color) {
     static int peakHold = 0;
     static unsigned long peakTime = 0;
-    int level = min(w, (int)(visPeak * w / 8000));
-    if (level > peakHold) { peakHold = level; peakTime = millis(); }
-    if (millis() - peakTime > 800) { peakHold = max(0, peakHold - 2); }
+    int level = min(w, (int)(frame.peak * w / 8000));
+    if (frame.first) {
+        if (level > peakHold) { peakHold = level; peakTime = frame.ms; }
+        if (frame.ms - peakTime > 800) { peakHold = max(0, peakHold - 2); }
+    }
     // Background
     canvas.fillRect(x, y, w, h, C_BG_DARK);
     // Green/yellow/red segments
@@ -1089,16 +2826,29 @@ void drawLogoBox(int x, int y, int sz, const Station &st) {
     canvas.drawString(ini, x + sz / 2, y + sz / 2 + 1);
 }
 
+void decodeLogo(M5Canvas &c, int x, int y, int sz, const Station &st) {
+    float sc = (float)sz / 120.0f;  // SOMA FM logos are 120x120
+    if (st.imageUrl.endsWith(".jpg") || st.imageUrl.endsWith(".jpeg")) {
+        c.drawJpg(logoData, logoDataLen, x, y, sz, sz, 0, 0, sc, sc);
+    } else {
+        c.drawPng(logoData, logoDataLen, x, y, sz, sz, 0, 0, sc, sc);
+    }
+}
+
 void drawLogo(int x, int y, int sz, int stationIdx) {
     Station &st = stations[stationIdx];
     if (logoValid && logoForIdx == stationIdx && logoData) {
-        float sc = (float)sz / 120.0f;  // SOMA FM logos are 120x120
-        String url = st.imageUrl;
-        if (url.endsWith(".jpg") || url.endsWith(".jpeg")) {
-            canvas.drawJpg(logoData, logoDataLen, x, y, sz, sz, 0, 0, sc, sc);
-        } else {
-            canvas.drawPng(logoData, logoDataLen, x, y, sz, sz, 0, 0, sc, sc);
+        // Decode once into logoLayer instead of once per band
+        if (logoLayerFor != stationIdx || logoLayer.width() != sz) {
+            logoLayerFor = -1;
+            logoLayer.deleteSprite();
+            if (logoLayer.createSprite(sz, sz)) {
+                decodeLogo(logoLayer, 0, 0, sz, st);
+                logoLayerFor = stationIdx;
+            }
         }
+        if (logoLayerFor == stationIdx) logoLayer.pushSprite(&canvas, x, y);
+        else decodeLogo(canvas, x, y, sz, st);  // no memory for the layer
     } else {
         drawLogoBox(x, y, sz, st);
     }
@@ -1107,72 +2857,155 @@ void drawLogo(int x, int y, int sz, int stationIdx) {
 // ═══════════════════════════════════════════════════════════
 //  SCREEN: STATION BROWSER
 // ═══════════════════════════════════════════════════════════
-void drawBrowser() {
-    canvas.fillSprite(C_BG);
+// ── Row cache ──
+// Station rows (star, title, genre tag) are rendered once into 2-bit
+// sprites, palette 0 transparent, 1 title, 2 genre, 3 star, so the
+// selection gradient shows through and the title colour is a palette
+// change. Entries are keyed by Station::rowKey, which follows the station
+// through sortStations(); only rows whose favourite flag or content
+// changed are re-rendered. ROW_CACHE covers the visible rows plus some
+// scroll margin and is recycled least-recently-used.
+#define ROW_CACHE     (VISIBLE_LINES + 4)
+#define ROW_W         (SCREEN_W - 2)   // scrollbar column is drawn live
+#define ROW_EASE_MS   60               // smooth-scroll time constant
+#define ROW_TEXT_X    (BROWSER_THUMBS ? 20 + THUMB_SZ : 18)   // title, after the thumbnail
+
+struct RowSprite {
+    uint32_t key  = 0;
+    uint32_t used = 0;
+    M5Canvas spr;
+};
+RowSprite rowCache[ROW_CACHE];
+uint32_t  rowTick = 0;
+int       browserPosPx = 0;       // viewport top, px into the list
+uint32_t  browserPosMs = 0;       // frame.ms of the last browser frame
+void sceneBrowser();
+
+// Row text at row top y; colours are palette indices in the cache
+void renderBrowserRow(M5Canvas &c, const Station &st, int y, uint16_t title,
+                      uint16_t genre, uint16_t star) {
+    int cy = y + LINE_H / 2;
+    if (st.fav) {
+        c.setFont(&fonts::Font0);
+        c.setTextDatum(MC_DATUM);
+        c.setTextColor(star);
+        c.drawString("*", 5, cy);
+    }
+    c.setFont(&fonts::Font2);
+    c.setTextDatum(ML_DATUM);
+    c.setTextColor(title);
+    c.drawString(fitText(c, st.title, SCREEN_W - 48 - ROW_TEXT_X), ROW_TEXT_X, cy);
+    c.setFont(&fonts::Font0);
+    c.setTextDatum(MR_DATUM);
+    c.setTextColor(genre);
+    c.drawString(shortGenre(st.genre), SCREEN_W - 5, cy);
+}
 
-    String hr = String(stationCount) + " stations";
-    drawHeader("SOMA FM", hr.c_str());
+M5Canvas *browserRow(int idx) {
+    const Station &st = stations[idx];
+    RowSprite *lru = &rowCache[0];
+    for (auto &r : rowCache) {
+        if (r.key == st.rowKey) {
+            r.used = ++rowTick;
+            return &r.spr;
+        }
+        if (r.used < lru->used) lru = &r;
+    }
+    RowSprite &r = *lru;
+    r.key = 0;
+    if (!r.spr.getBuffer()) {
+        r.spr.setColorDepth(2);
+        if (!r.spr.createSprite(ROW_W, LINE_H)) return nullptr;
+    }
+    r.spr.fillSprite(0);
+    renderBrowserRow(r.spr, st, 0, 1, 2, 3);
+    r.spr.setPaletteColor(2, st.color);
+    r.spr.setPaletteColor(3, C_ACCENT);
+    r.key  = st.rowKey;
+    r.used = ++rowTick;
+    return &r.spr;
+}
 
-    canvas.setFont(&fonts::Font2);
-    int vis = min((int)VISIBLE_LINES, stationCount - scrollOffset);
+// Ease the viewport toward scrollOffset; asks for frames while moving
+void browserScrollStep() {
+    int target = scrollOffset * LINE_H;
+    uint32_t dt = frame.ms - browserPosMs;
+    browserPosMs = frame.ms;
+    if (uiPrevScene != sceneBrowser) browserPosPx = target;  // just opened: no animation
+    int d = target - browserPosPx;
+    if (d == 0) return;
+    int view = VISIBLE_LINES * LINE_H;
+    if (abs(d) > view) browserPosPx = target - (d > 0 ? view : -view);  // long jumps
+    d = target - browserPosPx;
+    int step = max(1, (int)(abs(d) * min(dt, 40u) / ROW_EASE_MS));
+    browserPosPx += d > 0 ? min(step, d) : -min(step, -d);
+    if (browserPosPx != target) uiFrameIn(1000 / UI_VIS_FPS);
+}
 
-    for (int i = 0; i < vis; i++) {
-        int idx = scrollOffset + i;
-        int y   = CONTENT_Y + i * LINE_H;
+void sceneBrowser() {
+    uint32_t t = micros();
+    canvas.fillSprite(C_BG);
+    t = uiLap(LAYER_BODY, t);
+
+    String hr = String(stationCount) + (autoPlay ? " stations  AUTO" : " stations");
+    drawHeader("SOMA FM", hr.c_str());
+    t = uiLap(LAYER_HEADER, t);
+
+    if (frame.first) browserScrollStep();
+    int viewH = VISIBLE_LINES * LINE_H;
+    ClipSave clip = pushClip(canvas, 0, CONTENT_Y, SCREEN_W, viewH);
+    for (int idx = browserPosPx / LINE_H; idx < stationCount; idx++) {
+        int y = CONTENT_Y + idx * LINE_H - browserPosPx;
+        if (y >= CONTENT_Y + viewH) break;
+        if (y + LINE_H <= bandY || y >= bandY + bandH) continue;  // not in this band
         bool sel = (idx == selectedIdx);
         bool playing = (idx == playingIdx);
+        const Station &st = stations[idx];
 
-        if (sel) {
-            for (int j = 0; j < LINE_H; j++) {
-                uint16_t c = blendRGB(stations[idx].color, C_BG, j * 200 / LINE_H + 55);
-                canvas.drawFastHLine(0, y + j, SCREEN_W, c);
-            }
-        }
+        if (sel) drawRowGradient(canvas, y, st.color);
+        if (playing) canvas.fillCircle(st.fav ? 12 : 5, y + LINE_H / 2, 2, C_PLAYING);
 
-        if (playing) {
-            canvas.fillCircle(5, y + LINE_H / 2, 2, C_PLAYING);
+        uint16_t tc = sel ? C_WHITE : (playing ? C_PLAYING : C_GRAY);
+        if (M5Canvas *row = browserRow(idx)) {
+            row->setPaletteColor(1, tc);
+            row->pushSprite(&canvas, 0, y, 0);
+        } else {
+            renderBrowserRow(canvas, st, y, tc, st.color, C_ACCENT);  // no memory
         }
-        if (stations[idx].fav) {
-            // Gold star for favorites
-            int sx = playing ? 12 : 5, sy = y + LINE_H / 2;
-            canvas.setFont(&fonts::Font0);
-            canvas.setTextDatum(MC_DATUM);
-            canvas.setTextColor(C_ACCENT);
-            canvas.drawString("*", sx, sy);
+        if (BROWSER_THUMBS) {
+            if (const uint16_t *px = thumbFor(idx))
+                canvas.pushImage(18, y + 1, THUMB_SZ, THUMB_SZ, (const lgfx::swap565_t *)px);
+            else
+                canvas.drawRoundRect(18, y + 1, THUMB_SZ, THUMB_SZ, 2,
+                                     blendRGB(st.color, C_BG, 140));
         }
-
-        int nameX = 18;  // leave room for indicators
-        canvas.setFont(&fonts::Font2);
-        canvas.setTextDatum(ML_DATUM);
-        canvas.setTextColor(sel ? C_WHITE : (playing ? C_PLAYING : C_GRAY));
-        canvas.drawString(fitText(canvas, stations[idx].title, SCREEN_W - 66), nameX, y + LINE_H / 2);
-
-        canvas.setFont(&fonts::Font0);
-        canvas.setTextDatum(MR_DATUM);
-        canvas.setTextColor(stations[idx].color);
-        canvas.drawString(shortGenre(stations[idx].genre), SCREEN_W - 5, y + LINE_H / 2);
     }
+    popClip(canvas, clip);
 
     if (stationCount > (int)VISIBLE_LINES) {
         int thumbH = max(6, (int)(CONTENT_H * VISIBLE_LINES / stationCount));
-        int thumbY = CONTENT_Y + (CONTENT_H - thumbH) * scrollOffset /
-                     max(1, stationCount - (int)VISIBLE_LINES);
+        int thumbY = CONTENT_Y + (CONTENT_H - thumbH) * browserPosPx /
+                     max(1, (stationCount - (int)VISIBLE_LINES) * LINE_H);
         canvas.fillRect(SCREEN_W - 2, CONTENT_Y, 2, CONTENT_H, C_BG_DARK);
         canvas.fillRect(SCREEN_W - 2, thumbY, 2, thumbH, C_ACCENT);
     }
+    t = uiLap(LAYER_BODY, t);
 
     drawFooterBrowser();
-    canvas.pushSprite(0, 0);
+    uiLap(LAYER_FOOTER, t);
 }
 
+void drawBrowser() { renderFrame(sceneBrowser); }
+
 // ═══════════════════════════════════════════════════════════
 //  SCREEN: NOW PLAYING
 // ═══════════════════════════════════════════════════════════
-void drawPlayer() {
-    if (playingIdx < 0) return;
+void scenePlayer() {
     Station &st = stations[playingIdx];
 
+    uint32_t t = micros();
     canvas.fillSprite(C_BG);
+    t = uiLap(LAYER_BODY, t);
 
     // Header with genre color gradient
     drawGradient(canvas, 0, HEADER_H, blendRGB(st.color, C_BG, 180), st.color);
@@ -1180,189 +3013,1211 @@ void drawPlayer() {
     canvas.setTextColor(C_WHITE);
     canvas.setFont(&fonts::Font2);
     canvas.drawString("NOW PLAYING", 6, HEADER_H / 2);
-    if (aRunning) drawEqBars(SCREEN_W - 54, 4, 24, HEADER_H - 8);
+    if (recWant) {
+        canvas.fillCircle(104, HEADER_H / 2, 3, C_HEADER2);
+        canvas.setFont(&fonts::Font0);
+        canvas.drawString("REC", 110, HEADER_H / 2);
+    }
+    if (warmOn) {
+        canvas.setFont(&fonts::Font0);
+        canvas.setTextColor(C_GRAY);
+        canvas.drawString("WARM", 134, HEADER_H / 2);
+        canvas.setTextColor(C_WHITE);
+    }
+    if (aRunning) {
+        drawEqBars(SCREEN_W - 54, 4, 24, HEADER_H - 8);
+        if (!aPaused) uiFrameIn(UI_EQ_MS);
+    }
     drawBattery(SCREEN_W - 24, 6);
     canvas.drawFastHLine(0, HEADER_H - 1, SCREEN_W, st.color);
+    t = uiLap(LAYER_HEADER, t);
+
+    // Logo (64x64)
+    int logoSz = 64;
+    int logoX  = 4;
+    int logoY  = CONTENT_Y + 2;
+    drawLogo(logoX, logoY, logoSz, playingIdx);
+
+    // Right pane: title, genre, listeners, status+volume
+    int ix = logoX + logoSz + 6;
+    int rw = SCREEN_W - ix - 4;  // available width for right pane
+
+    canvas.setTextDatum(TL_DATUM);
+    // Favorite star before title
+    int titleX = ix;
+    if (st.fav) {
+        canvas.setFont(&fonts::Font2);
+        canvas.setTextColor(C_ACCENT);
+        canvas.drawString("*", ix, CONTENT_Y + 3);
+        titleX += 10;
+    }
+    canvas.setTextColor(C_WHITE);
+    canvas.setFont(&fonts::FreeSansBold9pt7b);
+    drawScrollText(canvas, st.title, titleX, CONTENT_Y + 3, rw - (titleX - ix), scrTitle,
+                   C_WHITE);
+
+    canvas.setFont(&fonts::Font2);
+    canvas.setTextColor(st.color);
+    drawScrollText(canvas, st.genre, ix, CONTENT_Y + 20, rw, scrGenre, st.color);
+
+    canvas.setFont(&fonts::Font0);
+    canvas.setTextColor(C_DARKGRAY);
+    canvas.drawString(String(st.listeners) + " listeners", ix, CONTENT_Y + 36);
+
+    // Status + volume bar in right pane
+    canvas.setFont(&fonts::Font0);
+    canvas.setTextDatum(TL_DATUM);
+    canvas.setTextColor(aPaused ? C_ACCENT : (aRunning ? C_PLAYING : C_ACCENT));
+    String statusTxt = aPaused ? "PAUSED" : (aRunning ? "STREAM" : "BUFFER");
+    int lag = tsLagSeconds();
+    if (!aPaused && aRunning && lag > 0) {
+        char buf[12];
+        snprintf(buf, sizeof(buf), "-%d:%02d", lag / 60, lag % 60);
+        statusTxt = buf;
+        canvas.setTextColor(C_ACCENT);
+    }
+    canvas.drawString(statusTxt, ix, CONTENT_Y + 50);
+    drawVolumeBar(ix + 44, CONTENT_Y + 49, rw - 48, 10);
+
+    // Divider (full width, below logo area)
+    int dy = CONTENT_Y + 68;
+    canvas.drawFastHLine(4, dy, SCREEN_W - 8, C_DARKGRAY);
+
+    int visY = dy + 3;
+    int visH = SCREEN_H - FOOTER_H - visY - 2;
+
+    if (visMode == VIS_OFF) {
+        // Current song (full width)
+        canvas.setFont(&fonts::Font2);
+        canvas.setTextDatum(TL_DATUM);
+        canvas.setTextColor(C_WHITE);
+        String trk = nowTrack.length() > 0 ? nowTrack : "Loading track info...";
+        drawScrollText(canvas, trk, 6, dy + 8, SCREEN_W - 12, scrSong, C_WHITE);
+    } else {
+        // Visualizer fills the area below divider
+        if (aRunning && !aPaused) {
+            drawVisualizer(4, visY, SCREEN_W - 8, visH, st.color);
+            uiFrameIn(1000 / UI_VIS_FPS);
+        }
+    }
+
+    t = uiLap(LAYER_BODY, t);
+
+    drawFooterPlayer();
+    uiLap(LAYER_FOOTER, t);
+}
+
+void drawPlayer() {
+    if (playingIdx >= 0) renderFrame(scenePlayer);
+}
+
+// ═══════════════════════════════════════════════════════════
+//  SCREEN: ERROR
+// ═══════════════════════════════════════════════════════════
+void sceneError() {
+    canvas.fillSprite(C_BG);
+    drawHeader("ERROR");
+    canvas.setTextDatum(MC_DATUM);
+    canvas.setTextColor(C_HEADER2);
+    canvas.setFont(&fonts::Font2);
+    canvas.drawString(errorMsg, SCREEN_W / 2, SCREEN_H / 2 - 8);
+    canvas.setTextColor(C_GRAY);
+    canvas.setFont(&fonts::Font0);
+    canvas.drawString("Press Enter to retry", SCREEN_W / 2, SCREEN_H / 2 + 14);
+    drawFooter("Enter: Retry");
+}
+
+void drawError() { renderFrame(sceneError); }
+
+// ═══════════════════════════════════════════════════════════
+//  AUDIO CONTROL
+// ═══════════════════════════════════════════════════════════
+String streamUrl(const String &id, const char *host = "ice1.somafm.com") {
+    return String("http://") + host + "/" + id + "-" +
+           String(STREAM_BITRATE) + "-" + STREAM_FORMAT;
+}
+
+// ── Stream server discovery & ranking (audio task only) ──
+// Candidate URLs come from the station's .pls (ice1/ice2/ice4/ice6...).
+// Each host keeps a smoothed time-to-first-byte and a failure count, and
+// connects try the best-scoring host first, failing over down the list.
+#define MAX_STREAM_CANDS  6
+#define MAX_SERVER_STATS  8
+
+struct ServerStat {
+    String   host;
+    HostRank rank;
+};
+ServerStat serverStats[MAX_SERVER_STATS];
+int        serverStatCount = 0;
+
+String streamCands[MAX_STREAM_CANDS];
+int    streamCandCount = 0;
+String streamCandsFor  = "";   // station id the candidate list belongs to
+String streamHost      = "";   // host currently streaming
+
+String urlHost(const String &url) {
+    int a = url.indexOf("//");
+    a = (a < 0) ? 0 : a + 2;
+    int b = url.indexOf('/', a);
+    return b < 0 ? url.substring(a) : url.substring(a, b);
+}
+
+ServerStat &serverStat(const String &host) {
+    for (int i = 0; i < serverStatCount; i++)
+        if (serverStats[i].host == host) return serverStats[i];
+    int i = (serverStatCount < MAX_SERVER_STATS) ? serverStatCount++ : MAX_SERVER_STATS - 1;
+    serverStats[i].host = host;
+    serverStats[i].rank = HostRank();
+    return serverStats[i];
+}
+
+uint32_t serverScore(const String &url) {
+    return serverStat(urlHost(url)).rank.score();
+}
+
+void noteServerResult(const String &host, bool ok, uint32_t ms) {
+    serverStat(host).rank.note(ok, ms);
+}
+
+// Fetch the .pls and collect its FileN= entries
+int fetchPlaylist(const String &plsUrl) {
+    int n = 0;
+    WiFiClientSecure secClient;
+    WiFiClient       plainClient;
+    HTTPClient http;
+    if (plsUrl.startsWith("https://")) {
+        secClient.setInsecure();
+        http.begin(secClient, plsUrl);
+    } else {
+        http.begin(plainClient, plsUrl);
+    }
+    http.setTimeout(STREAM_CONNECT_MS);
+    http.setFollowRedirects(HTTPC_STRICT_FOLLOW_REDIRECTS);
+    if (http.GET() == 200) {
+        Stream &in = http.getStream();
+        in.setTimeout(STREAM_CONNECT_MS);
+        while (n < MAX_STREAM_CANDS) {
+            String line = in.readStringUntil('\n');
+            if (line.length() == 0) break;
+            line.trim();
+            int eq = line.indexOf('=');
+            if (line.startsWith("File") && eq > 0 && line.indexOf("://") > eq)
+                streamCands[n++] = line.substring(eq + 1);
+        }
+    }
+    http.end();
+    return n;
+}
+
+// Fill streamCands for a station, ranked best-first
+void loadStreamCandidates(const String &id, const String &plsUrl) {
+    if (streamCandsFor != id || streamCandCount == 0) {
+        streamCandCount = plsUrl.length() ? fetchPlaylist(plsUrl) : 0;
+        if (streamCandCount == 0) {
+            // No playlist: fall back to the known SomaFM relay hosts
+            const char *hosts[] = { "ice1.somafm.com", "ice2.somafm.com",
+                                    "ice4.somafm.com", "ice6.somafm.com" };
+            for (const char *h : hosts) streamCands[streamCandCount++] = streamUrl(id, h);
+        }
+        streamCandsFor = id;
+        Serial.printf("[AUDIO] %d stream servers for %s\n", streamCandCount, id.c_str());
+    }
+    std::stable_sort(streamCands, streamCands + streamCandCount,
+        [](const String &a, const String &b) { return serverScore(a) < serverScore(b); });
+}
+
+// The ICY source keeps its HTTPClient private, so a stream connect is
+// bounded by HTTPClient's default timeout (5 s) rather than STREAM_CONNECT_MS
+#define STREAM_OPEN_MS 5000
+
+volatile uint32_t netGen     = 0;        // bumped to cancel background connects
+SemaphoreHandle_t streamLock = nullptr;  // guards candidate list + server stats
+
+// Try the ranked candidates in order; returns an open stream or nullptr.
+// Gives up early once a new command arrives, netGen moves past gen or
+// STREAM_BUDGET_MS would be exceeded (the caller then backs off; the hung
+// hosts have ranked down for the next try). streamLock is held only to
+// rank and to record results, not across the blocking opens.
+AudioFileSourceICYStream *connectStream(const String &id, const String &plsUrl,
+                                        uint32_t gen) {
+    String cands[MAX_STREAM_CANDS];
+    xSemaphoreTake(streamLock, portMAX_DELAY);
+    loadStreamCandidates(id, plsUrl);
+    int n = streamCandCount;
+    for (int i = 0; i < n; i++) cands[i] = streamCands[i];
+    xSemaphoreGive(streamLock);
+
+    AudioFileSourceICYStream *res = nullptr;
+    unsigned long start = millis();
+    int got = openWithinBudget(n, STREAM_OPEN_MS, STREAM_BUDGET_MS,
+        [] { return (uint32_t)millis(); },
+        [&](int i) {
+            String host = urlHost(cands[i]);
+            Serial.printf("[AUDIO] Connecting: %s  heap=%u\n",
+                          cands[i].c_str(), ESP.getFreeHeap());
+            unsigned long t0 = millis();
+            AudioFileSourceICYStream *src = new AudioFileSourceICYStream();
+            bool ok = src->open(cands[i].c_str());
+            uint32_t ms = millis() - t0;
+            xSemaphoreTake(streamLock, portMAX_DELAY);
+            noteServerResult(host, ok, ms);
+            if (ok && gen == netGen) streamHost = host;   // a stale job's host is not playing
+            xSemaphoreGive(streamLock);
+            if (ok) {
+                Serial.printf("[AUDIO] %s ttfb=%u ms\n", host.c_str(), ms);
+                res = src;
+                return true;
+            }
+            Serial.printf("[AUDIO] %s failed after %u ms\n", host.c_str(), ms);
+            delete src;
+            return false;
+        },
+        [&] { return aCmd != ACMD_NONE || gen != netGen; });
+    if (got < 0 && aCmd == ACMD_NONE && gen == netGen)
+        Serial.printf("[AUDIO] No server within %lu ms\n", millis() - start);
+    return res;
+}
+
+// Exponential backoff with ±25% jitter; streak 0 retries immediately
+uint32_t backoffMs(int streak) {
+    if (streak <= 0) return 0;
+    uint32_t ms = min((uint32_t)RECONNECT_MAX_MS,
+                      (uint32_t)RECONNECT_BASE_MS << min(streak - 1, 10));
+    return ms * 3 / 4 + esp_random() % (ms / 2 + 1);
+}
+
+// ── Network link: keeps buffered audio playing across reconnects ──
+// Bottom of the source chain. When the socket dies or stalls the link
+// reports dead(); the audio task detaches the stream, keeps decoding what
+// is already buffered and netTask connects a replacement in the
+// background. A new stream is resynced to the first MP3 frame header.
+#define LINK_STALL_MS 3000
+
+class AudioFileSourceLink : public AudioFileSource {
+public:
+    AudioFileSourceLink() : _src(nullptr), _pre(nullptr), _resync(false), _dead(false),
+                            _gate(true), _lastData(0) {}
+    ~AudioFileSourceLink() { dropPre(); }
+
+    // pre: optional bytes already read from src (warm standby), served first
+    void attach(AudioFileSourceICYStream *src, bool resync, ByteFifo *pre = nullptr) {
+        dropPre();
+        _src = src;
+        _pre = pre;
+        _resync = resync;
+        _dead = false;
+        _lastData = millis();
+    }
+    AudioFileSourceICYStream *detach() {
+        AudioFileSourceICYStream *s = _src;
+        dropPre();
+        _src = nullptr;
+        _dead = false;
+        return s;
+    }
+    bool attached() const { return _src != nullptr; }
+    void touch() { _lastData = millis(); }  // restart the stall timer (after pause)
+    // Burst mode: a closed gate reads nothing (and cannot stall)
+    void setGate(bool open) {
+        if (open && !_gate) _lastData = millis();
+        _gate = open;
+    }
+    bool gateOpen() const { return _gate; }
+    bool dead() const { return _dead; }
+
+    // Short bounded wait instead of HTTPStream's 500 ms blocking read
+    uint32_t read(void *data, uint32_t len) override {
+        uint32_t n = readNonBlock(data, len);
+        for (int i = 0; n == 0 && _src && !_dead && _gate && i < 5; i++) {
+            vTaskDelay(pdMS_TO_TICKS(10));
+            n = readNonBlock(data, len);
+        }
+        return n;
+    }
+    uint32_t readNonBlock(void *data, uint32_t len) override {
+        if (!_src || _dead || !_gate) return 0;
+        uint32_t n = _pre ? _pre->pop((uint8_t *)data, len) : 0;
+        if (_pre && _pre->used() == 0) dropPre();
+        if (n == 0) n = _src->readNonBlock(data, len);
+        if (n == 0) {
+            if (!_src->isOpen() || millis() - _lastData > LINK_STALL_MS) _dead = true;
+            return 0;
+        }
+        _lastData = millis();
+        if (_resync) n = resync((uint8_t *)data, n);
+        return n;
+    }
+    bool seek(int32_t, int) override { return false; }
+    bool close() override { return true; }
+    bool isOpen() override { return true; }  // stays open across reconnects
+    uint32_t getSize() override { return 0; }
+    uint32_t getPos() override { return _src ? _src->getPos() : 0; }
+
+private:
+    void dropPre() {
+        if (!_pre) return;
+        _pre->release();
+        delete _pre;
+        _pre = nullptr;
+    }
+
+    // Drop bytes up to the first plausible MPEG audio frame header
+    uint32_t resync(uint8_t *d, uint32_t n) {
+        for (uint32_t i = 0; i + 3 < n; i++) {
+            if (d[i] != 0xFF || (d[i + 1] & 0xE0) != 0xE0) continue;
+            if (((d[i + 1] >> 3) & 3) == 1 || ((d[i + 1] >> 1) & 3) == 0) continue;
+            if ((d[i + 2] >> 4) == 0xF || (d[i + 2] >> 4) == 0 || ((d[i + 2] >> 2) & 3) == 3) continue;
+            memmove(d, d + i, n - i);
+            _resync = false;
+            return n - i;
+        }
+        return 0;
+    }
+
+    AudioFileSourceICYStream *_src;
+    ByteFifo *_pre;
+    bool _resync;
+    bool _dead;
+    bool _gate;
+    unsigned long _lastData;
+};
+
+// ── Warm standby: neighbour stations pre-connected for instant skip ──
+// With 'w' on, netTask keeps the next and previous station open on the
+// host the current stream uses and reads each into a small prefill, so
+// '.'/';' start from buffered audio instead of a fresh connect. Once the
+// prefill is full the slot is not read: as with an A/B-parked stream the
+// TCP window fills and the server stops sending. After WARM_HOLD_MS the
+// socket is dropped and reopened, before the server gives up on a reader
+// that stopped. A slot is only opened while the heap stays above
+// WARM_MIN_HEAP plus its own cost, never while a reconnect job waits or
+// the playing link is down, and slots are closed (far one first) as soon
+// as the heap drops below WARM_MIN_HEAP.
+#define WARM_SLOT_COST   (WARM_PREFILL + 12288)  // prefill + socket buffers
+#define WARM_RETRY_MS    10000
+#define WARM_HOLD_MS     30000
+
+struct WarmSlot {
+    char      want[24];     // station id planned by the audio task ("" = none)
+    char      have[24];     // station id of the open stream
+    AudioFileSourceICYStream *src;
+    ByteFifo *pre;          // first WARM_PREFILL bytes of src
+    unsigned long opened;
+    unsigned long retryAt;  // after a failed open
+};
+WarmSlot          warmSlots[WARM_SLOTS > 0 ? WARM_SLOTS : 1];
+SemaphoreHandle_t warmLock = nullptr;
+uint32_t          warmHits = 0, warmMisses = 0;
+
+// Audio task: neighbours of idx to keep warm (-1 closes all slots)
+void warmPlan(int idx) {
+    int n = stationCount;
+    xSemaphoreTake(warmLock, portMAX_DELAY);
+    for (int i = 0; i < WARM_SLOTS; i++) {
+        int t = -1;
+        if (idx >= 0 && n > 1 && i < 2) t = (i == 0) ? (idx + 1) % n : (idx - 1 + n) % n;
+        if (i == 1 && n == 2) t = -1;  // prev == next
+        strlcpy(warmSlots[i].want, t >= 0 ? stations[t].id.c_str() : "",
+                sizeof(warmSlots[i].want));
+    }
+    xSemaphoreGive(warmLock);
+}
+
+// Audio task: take over the warm stream for id, with its prefill
+AudioFileSourceICYStream *warmClaim(const String &id, ByteFifo **pre) {
+    AudioFileSourceICYStream *src = nullptr;
+    xSemaphoreTake(warmLock, portMAX_DELAY);
+    for (int i = 0; i < WARM_SLOTS && !src; i++) {
+        WarmSlot &w = warmSlots[i];
+        if (!w.src || id != w.have) continue;
+        src  = w.src;
+        *pre = w.pre;
+        w.src = nullptr;
+        w.pre = nullptr;
+        w.have[0] = w.want[0] = 0;
+    }
+    xSemaphoreGive(warmLock);
+    if (src) warmHits++; else if (warmOn) warmMisses++;
+    return src;
+}
+
+void warmClose(WarmSlot &w, const char *why) {
+    Serial.printf("[WARM] Close %s (%s) heap=%u\n", w.have, why, ESP.getFreeHeap());
+    delete w.src;
+    if (w.pre) { w.pre->release(); delete w.pre; }
+    w.src = nullptr;
+    w.pre = nullptr;
+    w.have[0] = 0;
+}
+
+// netTask: follow the plan, top up each prefill, respect the heap budget.
+// mayOpen is false while a reconnect job is waiting or the link is down,
+// so a blocking speculative open never delays the playing stream.
+void warmService(bool mayOpen) {
+    static uint8_t tmp[512];
+    char open[24] = "";
+    int  openSlot = -1;
+    bool lowHeap  = ESP.getFreeHeap() < WARM_MIN_HEAP;
+
+    xSemaphoreTake(warmLock, portMAX_DELAY);
+    for (int i = WARM_SLOTS - 1; i >= 0; i--) {
+        WarmSlot &w = warmSlots[i];
+        if (w.src) {
+            if (strcmp(w.want, w.have) != 0) { warmClose(w, "replanned"); continue; }
+            if (lowHeap) { warmClose(w, "low heap"); lowHeap = false; continue; }
+            // Read only until the prefill is full, then let backpressure hold it
+            while (w.pre->space() > 0) {
+                uint32_t n = w.src->readNonBlock(tmp, min((uint32_t)sizeof(tmp), w.pre->space()));
+                if (n == 0) break;
+                w.pre->push(tmp, n);
+            }
+            if (!w.src->isOpen()) {
+                warmClose(w, "closed by server");
+                w.retryAt = millis() + WARM_RETRY_MS;
+            } else if (millis() - w.opened > WARM_HOLD_MS) {
+                warmClose(w, "hold expired");   // reopened on a later pass
+            }
+        } else if (mayOpen && w.want[0] && openSlot < 0 &&
+                   (long)(millis() - w.retryAt) >= 0) {
+            openSlot = i;
+            strlcpy(open, w.want, sizeof(open));
+        }
+    }
+    xSemaphoreGive(warmLock);
+    if (openSlot < 0 || ESP.getFreeHeap() < WARM_MIN_HEAP + WARM_SLOT_COST) return;
+
+    // SomaFM relays carry every channel, so reuse the proven host (and its
+    // already-resolved DNS entry) rather than fetching each .pls
+    // (skip this pass while a foreground connect holds the lock)
+    if (xSemaphoreTake(streamLock, 0) != pdTRUE) return;
+    String host = streamHost.length() ? streamHost : String("ice1.somafm.com");
+    xSemaphoreGive(streamLock);
+
+    uint32_t heap0 = ESP.getFreeHeap();
+    unsigned long t0 = millis();
+    AudioFileSourceICYStream *src = new AudioFileSourceICYStream();
+    bool ok = src->open(streamUrl(open, host.c_str()).c_str());
+    ByteFifo *pre = new ByteFifo();
+    if (ok) ok = pre->alloc(WARM_PREFILL);
+
+    xSemaphoreTake(warmLock, portMAX_DELAY);
+    WarmSlot &w = warmSlots[openSlot];
+    if (ok && !w.src && strcmp(w.want, open) == 0) {
+        strlcpy(w.have, open, sizeof(w.have));
+        w.src = src;
+        w.pre = pre;
+        w.opened = millis();
+        src = nullptr;
+        pre = nullptr;
+        Serial.printf("[WARM] Open %s on %s in %lu ms, cost=%d B heap=%u\n", open,
+                      host.c_str(), millis() - t0, (int)(heap0 - ESP.getFreeHeap()),
+                      ESP.getFreeHeap());
+    } else if (!ok) {
+        w.retryAt = millis() + WARM_RETRY_MS;
+        Serial.printf("[WARM] Open %s failed\n", open);
+    }
+    xSemaphoreGive(warmLock);
+    delete src;
+    if (pre) { pre->release(); delete pre; }
+}
 
-    // Logo (64x64)
-    int logoSz = 64;
-    int logoX  = 4;
-    int logoY  = CONTENT_Y + 2;
-    drawLogo(logoX, logoY, logoSz, playingIdx);
+// ── A/B toggle: the previous station stays connected, unread (audio task) ──
+// On a switch the outgoing stream is parked instead of closed. Nothing
+// reads it, so the TCP receive window fills and the server stops sending:
+// the parked connection costs its socket buffers but no bandwidth. Going
+// back claims it and playback resumes from where it was left. It is
+// released after AB_HOLD_MS, when the server closes it, or as soon as
+// free heap drops below AB_MIN_HEAP.
+AudioFileSourceICYStream *abSrc = nullptr;
+String        abId     = "";
+String        abHost   = "";
+unsigned long abSince  = 0;
+uint32_t      abHeap0  = 0;   // free heap just before parking
+
+void abRelease(const char *why) {
+    if (!abSrc) return;
+    uint32_t h = ESP.getFreeHeap();
+    delete abSrc;
+    abSrc = nullptr;
+    Serial.printf("[AB] Released %s (%s) after %lu s, freed %d B heap=%u\n", abId.c_str(),
+                  why, (millis() - abSince) / 1000, (int)(ESP.getFreeHeap() - h),
+                  ESP.getFreeHeap());
+}
 
-    // Right pane: title, genre, listeners, status+volume
-    int ix = logoX + logoSz + 6;
-    int rw = SCREEN_W - ix - 4;  // available width for right pane
+void abPark(AudioFileSourceICYStream *src, const String &id) {
+    abRelease("replaced");
+    if (AB_HOLD_MS <= 0 || !src || ESP.getFreeHeap() < AB_MIN_HEAP) { delete src; return; }
+    abSrc   = src;
+    abId    = id;
+    xSemaphoreTake(streamLock, portMAX_DELAY);   // netTask may be publishing a host
+    abHost  = streamHost;
+    xSemaphoreGive(streamLock);
+    abSince = millis();
+    abHeap0 = ESP.getFreeHeap();
+    Serial.printf("[AB] Parked %s heap=%u\n", id.c_str(), abHeap0);
+}
 
-    canvas.setTextDatum(TL_DATUM);
-    // Favorite star before title
-    int titleX = ix;
-    if (st.fav) {
-        canvas.setFont(&fonts::Font2);
-        canvas.setTextColor(C_ACCENT);
-        canvas.drawString("*", ix, CONTENT_Y + 3);
-        titleX += 10;
-    }
-    canvas.setTextColor(C_WHITE);
-    canvas.setFont(&fonts::FreeSansBold9pt7b);
-    drawScrollText(canvas, st.title, titleX, CONTENT_Y + 3, rw - (titleX - ix), scrTitle);
+AudioFileSourceICYStream *abClaim(const String &id) {
+    if (!abSrc || abId != id) return nullptr;
+    if (!abSrc->isOpen()) { abRelease("closed by server"); return nullptr; }
+    AudioFileSourceICYStream *src = abSrc;
+    abSrc = nullptr;
+    xSemaphoreTake(streamLock, portMAX_DELAY);
+    streamHost = abHost;
+    xSemaphoreGive(streamLock);
+    Serial.printf("[AB] Resume %s after %lu ms\n", id.c_str(), millis() - abSince);
+    return src;
+}
 
-    canvas.setFont(&fonts::Font2);
-    canvas.setTextColor(st.color);
-    drawScrollText(canvas, st.genre, ix, CONTENT_Y + 20, rw, scrGenre);
+// Periodic check of the parked stream against its time and memory budget
+void abService() {
+    if (!abSrc) return;
+    if (ESP.getFreeHeap() < AB_MIN_HEAP) abRelease("low heap");
+    else if (millis() - abSince > AB_HOLD_MS) abRelease("hold expired");
+    else if (!abSrc->isOpen()) abRelease("closed by server");
+}
 
-    canvas.setFont(&fonts::Font0);
-    canvas.setTextColor(C_DARKGRAY);
-    canvas.drawString(String(st.listeners) + " listeners", ix, CONTENT_Y + 36);
+// ── Crossfade on station switch (audio task) ──
+// The outgoing chain is moved aside and its decoder retargeted to
+// xfVoice; DirectI2SOutput pulls and mixes it out over XFADE_MS while the
+// new decoder starts. A second decoder plus its buffer needs roughly
+// 50 KB, so the fade is only attempted above XFADE_MIN_HEAP.
+class SomaMP3 : public AudioGeneratorMP3 {
+public:
+    void retarget(AudioOutput *o) { output = o; }
+};
 
-    // Status + volume bar in right pane
-    canvas.setFont(&fonts::Font0);
-    canvas.setTextDatum(TL_DATUM);
-    canvas.setTextColor(aPaused ? C_ACCENT : (aRunning ? C_PLAYING : C_ACCENT));
-    String statusTxt = aPaused ? "PAUSED" : (aRunning ? "STREAM" : "BUFFER");
-    canvas.drawString(statusTxt, ix, CONTENT_Y + 50);
-    drawVolumeBar(ix + 44, CONTENT_Y + 49, rw - 48, 10);
+struct XfChain {
+    AudioGeneratorMP3         *mp3;
+    AudioFileSourceBuffer     *buf;
+    AudioFileSourceTimeShift  *shift;
+    AudioFileSourceTee        *tee;
+    AudioFileSourceLink       *link;
+    String        id;
+    unsigned long t0;
+    uint32_t      heapMin;
+};
+XfChain  xfOld = {};
+MixVoice xfVoice;
+
+bool xfBegin(const String &id) {
+    if (!mp3 || !xfVoice.alloc()) return false;
+    xfOld.mp3     = mp3;
+    xfOld.buf     = audioBuf;
+    xfOld.shift   = audioShift;
+    xfOld.tee     = audioTee;
+    xfOld.link    = audioLink;
+    xfOld.id      = id;
+    xfOld.t0      = millis();
+    xfOld.heapMin = ESP.getFreeHeap();
+    if (audioSrc) audioSrc->RegisterMetadataCB(nullptr, nullptr);  // keep its titles out
+    if (audioTee) audioTee->mute();                                  // and its bytes
+    mp3 = nullptr; audioBuf = nullptr; audioShift = nullptr;
+    audioTee = nullptr; audioLink = nullptr; audioSrc = nullptr;
+    static_cast<SomaMP3 *>(xfOld.mp3)->retarget(&xfVoice);
+    return true;
+}
 
-    // Divider (full width, below logo area)
-    int dy = CONTENT_Y + 68;
-    canvas.drawFastHLine(4, dy, SCREEN_W - 8, C_DARKGRAY);
+// Tear down the outgoing chain; after a completed fade its stream is parked
+void xfFinish(bool park) {
+    if (!xfOld.mp3) return;
+    AudioFileSourceICYStream *src = xfOld.link ? xfOld.link->detach() : nullptr;
+    uint32_t us = static_cast<DirectI2SOutput *>(audioOut)->fadeDecodeUs();
+    unsigned long ms = millis() - xfOld.t0;
+    if (xfOld.mp3->isRunning()) xfOld.mp3->stop();
+    delete xfOld.mp3;
+    delete xfOld.buf;
+    delete xfOld.shift;
+    delete xfOld.tee;
+    delete xfOld.link;
+    if (park) abPark(src, xfOld.id); else delete src;
+    Serial.printf("[XFADE] %s after %lu ms, outgoing decode %u us (%u%% CPU), heap min %u\n",
+                  park ? "Done" : "Aborted", ms, us,
+                  (unsigned)(us / max(1UL, ms * 10)), xfOld.heapMin);
+    xfOld = {};
+}
 
-    int visY = dy + 3;
-    int visH = SCREEN_H - FOOTER_H - visY - 2;
+// ── netTask (Core 0, below audioTask): background stream connects ──
+struct NetJob {
+    char     id[24];
+    char     pls[112];
+    uint32_t delayMs;
+    uint32_t gen;
+};
+struct NetDone {
+    AudioFileSourceICYStream *src;
+    uint32_t gen;
+};
+QueueHandle_t netJobQ  = nullptr;
+QueueHandle_t netDoneQ = nullptr;
+
+// False when the job queue is full
+bool postReconnect(const String &id, const String &pls, uint32_t delayMs) {
+    NetJob j = {};
+    strlcpy(j.id, id.c_str(), sizeof(j.id));
+    strlcpy(j.pls, pls.c_str(), sizeof(j.pls));
+    j.delayMs = delayMs;
+    j.gen     = netGen;
+    return xQueueSend(netJobQ, &j, 0) == pdTRUE;
+}
 
-    if (visMode == VIS_OFF) {
-        // Current song (full width)
-        canvas.setFont(&fonts::Font2);
-        canvas.setTextDatum(TL_DATUM);
-        canvas.setTextColor(C_WHITE);
-        String trk = nowTrack.length() > 0 ? nowTrack : "Loading track info...";
-        drawScrollText(canvas, trk, 6, dy + 8, SCREEN_W - 12, scrSong);
-    } else {
-        // Visualizer fills the area below divider
-        if (aRunning && !aPaused) {
-            drawVisualizer(4, visY, SCREEN_W - 8, visH, st.color);
+void netTask(void *) {
+    for (;;) {
+        NetJob j;
+        if (xQueueReceive(netJobQ, &j, pdMS_TO_TICKS(20)) != pdTRUE) {
+            warmService(aLinkUp);
+            continue;
         }
+        for (uint32_t t = 0; t < j.delayMs && j.gen == netGen; t += 50) {
+            warmService(false);
+            vTaskDelay(pdMS_TO_TICKS(50));
+        }
+        if (j.gen != netGen) continue;
+        // Failures are reported too (src == nullptr) so the audio task can
+        // schedule the next attempt
+        NetDone d = { connectStream(j.id, j.pls, j.gen), j.gen };
+        if (xQueueSend(netDoneQ, &d, 0) != pdTRUE) delete d.src;
     }
-
-    drawFooterPlayer();
-    canvas.pushSprite(0, 0);
 }
 
-// ═══════════════════════════════════════════════════════════
-//  SCREEN: ERROR
-// ═══════════════════════════════════════════════════════════
-void drawError() {
-    canvas.fillSprite(C_BG);
-    drawHeader("ERROR");
-    canvas.setTextDatum(MC_DATUM);
-    canvas.setTextColor(C_HEADER2);
-    canvas.setFont(&fonts::Font2);
-    canvas.drawString(errorMsg, SCREEN_W / 2, SCREEN_H / 2 - 8);
-    canvas.setTextColor(C_GRAY);
-    canvas.setFont(&fonts::Font0);
-    canvas.drawString("Press Enter to retry", SCREEN_W / 2, SCREEN_H / 2 + 14);
-    drawFooter("Enter: Retry");
-    canvas.pushSprite(0, 0);
+// ── Burst mode: duty-cycle the radio (audio task) ──
+// With a BURST_BUF_KB stream buffer the link is read flat out until the
+// buffer is nearly full, then gated shut and the radio put into modem
+// sleep until the buffer drains to a third. Current figures are typical
+// ESP32-S3 values, used only for the logged estimate.
+#define BURST_RADIO_ON_MA    95   // receiving, power save off
+#define BURST_RADIO_SLEEP_MA 30   // associated, max modem sleep
+
+struct BurstStats {
+    uint32_t onMs;       // gate open (radio awake) in this window
+    uint32_t bursts;
+    uint64_t fillSum;
+    uint32_t fillN;
+};
+BurstStats burst = {};
+bool       burstSleeping = false;
+
+void burstRadio(bool awake) {
+    if (burstSleeping == !awake) return;
+    burstSleeping = !awake;
+    esp_wifi_set_ps(awake ? WIFI_PS_NONE : WIFI_PS_MAX_MODEM);
 }
 
-// ═══════════════════════════════════════════════════════════
-//  AUDIO CONTROL
-// ═══════════════════════════════════════════════════════════
-String streamUrl(const String &id) {
-    return String("http://ice1.somafm.com/") + id + "-" +
-           String(STREAM_BITRATE) + "-" + STREAM_FORMAT;
+// Config files from before the band renderer ask for an 8 KB buffer; the
+// ~38 KB it freed lets the stream buffer be at least STREAM_BUF_MIN
+#define STREAM_BUF_SIZE (AUDIO_BUF_SIZE > STREAM_BUF_MIN ? AUDIO_BUF_SIZE : STREAM_BUF_MIN)
+
+// Stream buffer size: the burst ring when the heap can spare it, else
+// STREAM_BUF_SIZE, else the configured size
+uint32_t streamBufSize() {
+    uint32_t want = BURST_BUF_KB * 1024, size = STREAM_BUF_SIZE;
+    if (want > size && !warmOn && ESP.getMaxAllocHeap() >= want &&
+        ESP.getFreeHeap() >= want + BURST_MIN_HEAP) {
+        size = want;
+    } else {
+        if (want > size)
+            Serial.printf("[BURST] Off (heap=%u, largest=%u)\n", ESP.getFreeHeap(),
+                          ESP.getMaxAllocHeap());
+        if (size > AUDIO_BUF_SIZE && (ESP.getMaxAllocHeap() < size ||
+                                      ESP.getFreeHeap() < size + BURST_MIN_HEAP))
+            size = AUDIO_BUF_SIZE;
+    }
+    Serial.printf("[AUDIO] Stream buffer %u B (AUDIO_BUF_SIZE %u)\n", size,
+                  (uint32_t)AUDIO_BUF_SIZE);
+    return size;
 }
 
+// Reconnect statistics (audio task)
+struct ReconnectStats {
+    uint32_t count, latSum, latMax;   // link down → replacement attached
+    uint32_t gaps, gapSum, gapMax;    // decoder starved while waiting
+};
+ReconnectStats rcStats = {};
+
 void cleanupAudio() {
     if (mp3)       { if (mp3->isRunning()) mp3->stop(); delete mp3; mp3 = nullptr; }
     if (audioBuf)  { delete audioBuf;  audioBuf  = nullptr; }
+    if (audioShift){ delete audioShift; audioShift = nullptr; }
+    if (audioTee)  { delete audioTee;  audioTee  = nullptr; }
+    if (audioLink) { delete audioLink; audioLink = nullptr; }
     if (audioSrc)  { delete audioSrc;  audioSrc  = nullptr; }
+    tsEnd();
     aRunning = false;
     // Flush I2S DMA buffers so old audio doesn't bleed into new stream
     if (audioOut) audioOut->stop();
+    burstRadio(true);
+    esp_wifi_set_ps(WIFI_PS_MIN_MODEM);  // Arduino default
+}
+
+int aFailStreak = 0;   // consecutive failed plays / reconnects (audio task)
+unsigned long pendPlayAt = 0;   // next pending-play attempt (audio task)
+
+// Play id again after the backoff; a new command cancels it
+void retryPlay(const String &id, const String &pls) {
+    uint32_t wait = backoffMs(++aFailStreak);
+    Serial.printf("[AUDIO] Retry %d of %s in %u ms\n", aFailStreak, id.c_str(), wait);
+    pendPlayId  = id;
+    pendPlayPls = pls;
+    pendPlayAt  = millis() + wait;
 }
 
 // ── Audio FreeRTOS task (Core 0) ─────────────────────────
 void audioTask(void *) {
+    // Audio hardware bring-up runs here while Core 1 shows the browser:
+    // release M5.Speaker's I2S port, drive it directly, re-init the codec
+    M5.Speaker.end();
+    vTaskDelay(pdMS_TO_TICKS(100));
+    audioOut->begin();
+    es8311_init_dac();
+    aHwReady = true;
+    bootMark("audio hw");
+    Serial.println("[SETUP] DirectI2S on port 1, ES8311 init");
+
+    unsigned long pauseStart = 0;   // 0 = not paused
+    bool          parked     = false;  // connection dropped during a long pause
+    uint32_t      busyUs     = 0;
+    unsigned long statsStart = millis();
+    unsigned long linkDownAt = 0;   // 0 = link healthy
+    unsigned long gapStart   = 0;   // 0 = decoder not starved
+    unsigned long attachedAt = 0;
+    int           warmFor    = -1;  // station whose neighbours are planned warm
+    unsigned long tAbCheck   = 0;
+    String        curId = "", curPls = "";
+    uint32_t      bufSize    = STREAM_BUF_SIZE;  // size of the current stream buffer
+    unsigned long burstMark  = millis();
+    int           xfTarget   = -1;  // station being connected for a crossfade
+    String        xfId = "", xfPls = "";   // its id/playlist when the command came
+    unsigned long xfCmdAt    = 0;
+    unsigned long xfPostAt   = 0;   // when its connect job was (re)posted
+    bool          xfReposted = false;
+    unsigned long repostAt   = 0;   // reconnect job to post again (queue was full)
+
+    // Current list index of a station id (-1 if not in the list)
+    auto stationOf = [](const String &id) {
+        for (int i = 0; i < stationCount; i++)
+            if (stations[i].id == id) return i;
+        return -1;
+    };
+
+    // Move the playing chain out of the way: into a crossfade when asked
+    // and memory allows, otherwise park its stream (A/B) and close it
+    auto retire = [&](bool fade, const String &id) {
+        if (fade && ESP.getFreeHeap() < XFADE_MIN_HEAP)
+            Serial.printf("[XFADE] Skipped, heap=%u\n", ESP.getFreeHeap());
+        else if (fade && xfBegin(curId))
+            return;
+        if (audioLink && audioLink->attached() && id != curId && !aPaused) {
+            abPark(audioLink->detach(), curId);
+            audioSrc = nullptr;
+        }
+        cleanupAudio();
+    };
+
+    // Build the source chain and decoder on a connected stream
+    // (idx is -1 for an auto-play that Core 1 has not mapped yet)
+    auto startChain = [&](AudioFileSourceICYStream *src, int idx, const String &id,
+                          const String &pls, ByteFifo *pre, bool resync, const char *how,
+                          unsigned long tCmd) {
+        curId  = id;
+        curPls = pls;
+        icyActive = false;
+        icyTitle[0] = 0;
+        strlcpy(recStation, curId.c_str(), sizeof(recStation));
+        attachedAt = millis();
+        audioSrc   = src;
+        audioSrc->RegisterMetadataCB(icyMetadataCB, nullptr);
+        audioLink  = new AudioFileSourceLink();
+        audioLink->attach(audioSrc, resync, pre);
+        audioTee   = new AudioFileSourceTee(audioLink);
+        audioShift = new AudioFileSourceTimeShift(audioTee);
+        bufSize    = streamBufSize();
+        audioBuf = new AudioFileSourceBuffer(audioShift, bufSize);
+        // Pre-fill buffer before starting decoder to avoid initial stutter
+        audioBuf->loop();
+        mp3      = new SomaMP3();
+
+        if (mp3->begin(audioBuf, audioOut)) {
+            aRunning   = true;
+            if (idx >= 0) playingIdx = idx;
+            if (recOn) recRequestSplit("stream");
+            if (xfOld.mp3)
+                static_cast<DirectI2SOutput *>(audioOut)->startFade(
+                    &xfVoice, xfOld.mp3, (uint32_t)XFADE_MS * 441 / 10);
+            Serial.printf("[AUDIO] Playing! %s start in %lu ms heap=%u\n",
+                          how, millis() - tCmd, ESP.getFreeHeap());
+            if (warmOn)
+                Serial.printf("[WARM] hits=%u misses=%u\n", warmHits, warmMisses);
+        } else {
+            Serial.println("[AUDIO] begin() FAILED");
+            xfFinish(false);
+            cleanupAudio();
+            retryPlay(id, pls);
+        }
+    };
+
     for (;;) {
+        recService();
+        aBufFill = audioBuf ? audioBuf->getFillLevel() : 0;
+        aLinkUp  = audioLink && audioLink->attached();
+
+        // Pending play by id: the boot auto-play (connect and prefill as
+        // soon as WiFi associates, while Core 1 is still loading the channel
+        // list) and every retry. Handled here, not through aCmd, so a key
+        // press landing now is never overwritten; failed connects are
+        // retried with backoff until one succeeds or a command supersedes it
+        if (pendPlayId.length() && aCmd == ACMD_NONE && WiFi.status() == WL_CONNECTED &&
+            (long)(millis() - pendPlayAt) >= 0) {
+            unsigned long tCmd = millis();
+            bool boot = !tFirstPlay;
+            if (boot) { tFirstPlay = millis(); bootMark("play"); }
+            String id = pendPlayId, pls = pendPlayPls;
+            Serial.printf("[AUDIO] %s %s\n", boot ? "Auto-play" : "Retrying", id.c_str());
+            netGen++;
+            AudioFileSourceICYStream *src = connectStream(id, pls, netGen);
+            if (!src) {
+                if (aCmd == ACMD_NONE) retryPlay(id, pls);
+                continue;
+            }
+            pendPlayId = "";
+            startChain(src, stationOf(id), id, pls, nullptr, false, boot ? "boot" : "retry", tCmd);
+            bootPlaying = aRunning;
+            continue;
+        }
+
         // Check for commands - single variable, no race condition
         int cmd = aCmd;
         if (cmd != ACMD_NONE) {
+            unsigned long tCmd = millis();
             aCmd = ACMD_NONE;
-            cleanupAudio();
-            Serial.printf("[AUDIO] cmd=%d target=%d\n", cmd, aTarget);
-
-            if (cmd == ACMD_PLAY) {
-                int idx = aTarget;
-                if (idx >= 0 && idx < stationCount) {
-                    String url = streamUrl(stations[idx].id);
-                    Serial.printf("[AUDIO] Connecting: %s  heap=%u\n",
-                                  url.c_str(), ESP.getFreeHeap());
-
-                    audioSrc = new AudioFileSourceHTTPStream(url.c_str());
-                    audioBuf = new AudioFileSourceBuffer(audioSrc, AUDIO_BUF_SIZE);
-                    // Pre-fill buffer before starting decoder to avoid initial stutter
-                    audioBuf->loop();
-                    mp3      = new AudioGeneratorMP3();
-
-                    if (mp3->begin(audioBuf, audioOut)) {
-                        aRunning   = true;
-                        playingIdx = idx;
-                        Serial.printf("[AUDIO] Playing! heap=%u\n", ESP.getFreeHeap());
-                    } else {
-                        Serial.println("[AUDIO] begin() FAILED");
-                        cleanupAudio();
-                    }
+            netGen++;  // cancel any background reconnect
+            pauseStart = 0;
+            parked     = false;
+            linkDownAt = gapStart = 0;
+            repostAt   = 0;
+            xfFinish(false);  // switching again mid-fade drops the outgoing chain
+            xfTarget = -1;
+            int  idx  = aTarget;
+            bool play = cmd == ACMD_PLAY && idx >= 0 && idx < stationCount;
+            String id  = play ? stations[idx].id : String("");
+            String pls = play ? stations[idx].plsUrl : String("");
+            pendPlayId = "";  // any command supersedes a pending play or retry
+            // A parked (A/B) or warm stream for the target skips the connect
+            ByteFifo *pre = nullptr;
+            AudioFileSourceICYStream *src = play ? abClaim(id) : nullptr;
+            if (play && !src) src = warmClaim(id, &pre);
+            bool fade = play && XFADE_MS > 0 && id != curId && mp3 && mp3->isRunning() &&
+                        !aPaused && !(audioShift && audioShift->shifting());
+            Serial.printf("[AUDIO] cmd=%d target=%d%s\n", cmd, aTarget,
+                          fade ? " (crossfade)" : "");
+            if (!play) {
+                abRelease("stopped");
+                cleanupAudio();
+                continue;
+            }
+            if (fade && !src) {
+                // Keep the outgoing station playing while netTask connects
+                if (postReconnect(id, pls, 0)) {
+                    xfTarget   = idx;
+                    xfId       = id;
+                    xfPls      = pls;
+                    xfCmdAt    = xfPostAt = tCmd;
+                    xfReposted = false;
+                    continue;
                 }
+                Serial.println("[XFADE] Net queue full, switching without a fade");
+                fade = false;
+            }
+            retire(fade, id);
+            bool warm = src != nullptr;
+            if (!warm) src = connectStream(id, pls, netGen);
+            if (!src) {
+                Serial.println("[AUDIO] All stream servers failed");
+                if (aCmd == ACMD_NONE) retryPlay(id, pls);
+                continue;
             }
+            startChain(src, idx, id, pls, pre, warm, warm ? "warm" : "cold", tCmd);
             continue;  // Re-check commands before looping audio
         }
 
+        if (xfOld.mp3) {
+            xfOld.heapMin = min(xfOld.heapMin, (uint32_t)ESP.getFreeHeap());
+            if (!static_cast<DirectI2SOutput *>(audioOut)->fading()) xfFinish(true);
+        }
+
+        if (millis() - tAbCheck >= 250) {
+            tAbCheck = millis();
+            abService();
+        }
+
+        // Warm standby follows the playing station once it has been stable
+        // for a few seconds; paused or reconnecting closes the slots
+        int warmWant = (warmOn && aRunning && !aPaused && audioLink && audioLink->attached() &&
+                        millis() - attachedAt > 5000) ? playingIdx : -1;
+        if (warmWant != warmFor) {
+            warmFor = warmWant;
+            warmPlan(warmFor);
+        }
+
+        // Paused: stop calling the decoder so neither MP3 decode nor the
+        // HTTP read runs. With time-shift the stream keeps being recorded;
+        // otherwise the unread socket applies TCP backpressure and after
+        // PAUSE_HOLD_MS the connection is dropped and resume reconnects.
+        if (aPaused && (mp3 || parked)) {
+            if (pauseStart == 0) {
+                pauseStart = millis();
+                xfFinish(false);
+                if (audioOut) audioOut->stop();  // silence DMA instead of looping it
+                if (mp3) tsBegin();
+                Serial.println("[AUDIO] Paused, decoder idle");
+            }
+            bool recording = audioShift && tsWant != 0 && !tsFailed;
+            if (recording) {
+                audioShift->pump();
+            } else if (!parked && millis() - pauseStart >= PAUSE_HOLD_MS) {
+                Serial.println("[AUDIO] Pause hold expired, dropping stream");
+                cleanupAudio();
+                parked = true;
+            }
+            vTaskDelay(pdMS_TO_TICKS(20));
+            continue;
+        }
+        if (pauseStart != 0) {
+            Serial.printf("[AUDIO] Resumed after %lu ms%s\n", millis() - pauseStart,
+                          parked ? ", reconnecting" : "");
+            pauseStart = 0;
+            if (audioLink) audioLink->touch();
+            if (parked) {   // reconnect what was playing, by id
+                parked      = false;
+                pendPlayId  = curId;
+                pendPlayPls = curPls;
+                pendPlayAt  = millis();
+                continue;
+            }
+        }
+
+        // Time-shifted playback runs slightly fast until it is back at live
+        if (audioOut)
+            static_cast<DirectI2SOutput *>(audioOut)->setSpeed(
+                audioShift && audioShift->shifting() ? TS_CATCHUP_PCT : 0);
+
+        // Link died: drop the socket, keep decoding the buffer, reconnect in
+        // the background with exponential backoff
+        if (xfTarget < 0 && audioLink && audioLink->dead()) {
+            delete audioLink->detach();
+            audioSrc   = nullptr;
+            linkDownAt = millis();
+            uint32_t wait = backoffMs(aFailStreak++);
+            Serial.printf("[NET] Stream lost, reconnecting in %u ms (buffer %u B)\n",
+                          wait, audioBuf ? audioBuf->getFillLevel() : 0);
+            if (!postReconnect(curId, curPls, wait)) repostAt = millis() + wait;
+        }
+        if (repostAt && (long)(millis() - repostAt) >= 0) {
+            repostAt = 0;
+            if (audioLink && !audioLink->attached() && !postReconnect(curId, curPls, 0))
+                repostAt = millis() + 200;
+        }
+
+        // Crossfade connect overdue: netTask answers within the .pls fetch,
+        // one warm open and STREAM_BUDGET_MS, so its job or result was lost.
+        // The outgoing station keeps playing while the job is posted once
+        // more; if that is overdue too, cut over and retry with backoff
+        if (xfTarget >= 0 &&
+            millis() - xfPostAt > STREAM_CONNECT_MS + STREAM_OPEN_MS + STREAM_BUDGET_MS) {
+            netGen++;   // a late result is stale now
+            if (!xfReposted && postReconnect(xfId, xfPls, 0)) {
+                Serial.println("[XFADE] Connect overdue, posting it again");
+                xfReposted = true;
+                xfPostAt   = millis();
+            } else {
+                Serial.println("[XFADE] Connect failed, switching without a fade");
+                xfTarget = -1;
+                cleanupAudio();
+                retryPlay(xfId, xfPls);
+            }
+            continue;
+        }
+        NetDone done;
+        if (xQueueReceive(netDoneQ, &done, 0) == pdTRUE) {
+            if (xfTarget >= 0 && done.gen == netGen) {
+                // Crossfade target connected (or failed: fall back to a retry).
+                // The stream is for xfId; the list may have been re-sorted
+                // since, so look its index up again
+                int idx = stationOf(xfId);
+                xfTarget = -1;
+                if (done.src) {
+                    retire(true, xfId);
+                    startChain(done.src, idx, xfId, xfPls, nullptr, false, "cold", xfCmdAt);
+                } else {
+                    cleanupAudio();
+                    retryPlay(xfId, xfPls);
+                }
+            } else if (!done.src) {
+                if (done.gen == netGen && audioLink && !audioLink->attached()) {
+                    uint32_t wait = backoffMs(aFailStreak++);
+                    Serial.printf("[NET] Reconnect failed, next try in %u ms\n", wait);
+                    if (!postReconnect(curId, curPls, wait)) repostAt = millis() + wait;
+                }
+            } else if (done.gen == netGen && audioLink && !audioLink->attached()) {
+                audioSrc = done.src;
+                audioSrc->RegisterMetadataCB(icyMetadataCB, nullptr);
+                audioLink->attach(audioSrc, true);
+                attachedAt = millis();
+                uint32_t lat = attachedAt - linkDownAt;
+                rcStats.count++;
+                rcStats.latSum += lat;
+                rcStats.latMax = max(rcStats.latMax, lat);
+                linkDownAt = 0;
+                xSemaphoreTake(streamLock, portMAX_DELAY);
+                String host = streamHost;
+                xSemaphoreGive(streamLock);
+                Serial.printf("[NET] Reconnected to %s in %u ms\n", host.c_str(), lat);
+                if (recOn) recRequestSplit("reconnect");
+            } else {
+                delete done.src;  // stale result from a cancelled job
+            }
+        }
+        if (aFailStreak && attachedAt && audioLink && audioLink->attached() &&
+            millis() - attachedAt > 10000)
+            aFailStreak = 0;   // stable again
+
+        // Burst mode: gate the link shut near full, reopen at a third
+        if (bufSize > STREAM_BUF_SIZE && audioLink && audioBuf && !aPaused) {
+            uint32_t fill = audioBuf->getFillLevel();
+            bool open = audioLink->gateOpen();
+            if (open) burst.onMs += millis() - burstMark;
+            burstMark = millis();
+            burst.fillSum += fill;
+            burst.fillN++;
+            if (warmOn) {
+                audioLink->setGate(true);   // warm slots keep the radio busy anyway
+                burstRadio(true);
+            } else if (open && fill + 1024 >= bufSize) {
+                audioLink->setGate(false);
+                burstRadio(false);
+            } else if (!open && fill <= bufSize / 3) {
+                burstRadio(true);
+                audioLink->setGate(true);
+                burst.bursts++;
+            }
+        }
+
+        // Hold the decoder (instead of letting it fail) while the buffer is
+        // empty and the link is down, so the stream resumes without restart
+        if (mp3 && audioLink && audioBuf) {
+            uint32_t fill = audioBuf->getFillLevel();
+            bool starving = (!audioLink->attached() && fill < 1024) ||
+                            (gapStart && fill < 4096 && millis() - gapStart < 20000);
+            if (starving) {
+                if (!gapStart) gapStart = millis();
+                if (audioOut)  // a network gap, not a decode miss
+                    static_cast<DirectI2SOutput *>(audioOut)->restartDeadline();
+                audioBuf->loop();
+                vTaskDelay(pdMS_TO_TICKS(5));
+                continue;
+            }
+            if (gapStart) {
+                uint32_t gap = millis() - gapStart;
+                rcStats.gaps++;
+                rcStats.gapSum += gap;
+                rcStats.gapMax = max(rcStats.gapMax, gap);
+                gapStart = 0;
+                Serial.printf("[NET] reconnects=%u latency avg %u / max %u ms, "
+                              "gaps=%u avg %u / max %u ms\n",
+                              rcStats.count, rcStats.latSum / max((uint32_t)1, rcStats.count),
+                              rcStats.latMax, rcStats.gaps,
+                              rcStats.gapSum / rcStats.gaps, rcStats.gapMax);
+            }
+        }
+
         // Run audio decoder
         if (mp3 && mp3->isRunning()) {
-            if (!mp3->loop()) {
+            uint32_t t0 = micros();
+            bool ok = mp3->loop();
+            busyUs += micros() - t0;
+            // Full clock while the DMA queue is short or a crossfade runs
+            // two decoders
+            DirectI2SOutput *dout = static_cast<DirectI2SOutput *>(audioOut);
+            if (dout && (dout->fading() || dout->slackUs() < 8000))
+                aBoostUntil = millis() + 2000;
+            if (!ok) {
                 Serial.println("[AUDIO] Stream ended, retrying...");
+                // Rank this host down (netTask may be in connectStream,
+                // writing the same stats and streamHost)
+                xSemaphoreTake(streamLock, portMAX_DELAY);
+                noteServerResult(streamHost, false, 0);
+                xSemaphoreGive(streamLock);
                 cleanupAudio();
-                // Interruptible wait before retry
-                for (int i = 0; i < 20 && aCmd == ACMD_NONE; i++)
-                    vTaskDelay(pdMS_TO_TICKS(100));
-                // Auto-retry only if no new command arrived
-                if (aCmd == ACMD_NONE) {
-                    aTarget = playingIdx;
-                    aCmd    = ACMD_PLAY;
-                }
+                retryPlay(curId, curPls);
+            }
+        }
+
+        // Decoder CPU load: time inside mp3->loop() minus time blocked on DMA
+        if (millis() - statsStart >= 10000) {
+            uint32_t wait = aI2sWaitUs;
+            aI2sWaitUs = 0;
+            uint32_t cpu  = busyUs > wait ? busyUs - wait : 0;
+            aCpuLoad = min(100UL, cpu / ((millis() - statsStart) * 10));
+            uint32_t win = millis() - statsStart;
+            busyUs     = 0;
+            statsStart = millis();
+            Serial.printf("[AUDIO] cpu=%u%% @%u MHz miss=%u %s heap=%u\n", aCpuLoad,
+                          getCpuFrequencyMhz(), aDecodeMiss,
+                          aPaused ? "paused" : (aRunning ? "playing" : "idle"),
+                          ESP.getFreeHeap());
+            if (bufSize > STREAM_BUF_SIZE && burst.fillN) {
+                uint32_t duty = min((uint32_t)100, burst.onMs * 100 / win);
+                Serial.printf("[BURST] radio on %u%% (%u ms), bursts=%u, avg fill %u/%u B, "
+                              "est. saving ~%u mA\n", duty, burst.onMs, burst.bursts,
+                              (uint32_t)(burst.fillSum / burst.fillN), bufSize,
+                              (100 - duty) * (BURST_RADIO_ON_MA - BURST_RADIO_SLEEP_MA) / 100);
+                burst = {};
             }
+            if (abSrc)
+                Serial.printf("[AB] Holding %s for %lu s, heap=%u (%d B since parked) min=%u\n",
+                              abId.c_str(), (millis() - abSince) / 1000, ESP.getFreeHeap(),
+                              (int)(abHeap0 - ESP.getFreeHeap()), ESP.getMinFreeHeap());
         }
 
         vTaskDelay(1);
     }
 }
 
+// True when online. Otherwise starts connecting with the stored creds (or
+// opens WiFi setup when there are none) and returns false.
 bool ensureWifi() {
     if (WiFi.status() == WL_CONNECTED) return true;
-    // Try stored creds
     String ssid = loadWifiSSID();
     if (ssid.length() > 0) {
-        if (tryWifiConnect(ssid, loadWifiPass())) return true;
+        startWifiAuto(appState);
+    } else {
+        startWifiScan();
+        appState = STATE_WIFI_SCAN;
     }
-    // No creds or connect failed — go to WiFi setup
-    startWifiScan();
-    appState = STATE_WIFI_SCAN;
     return false;
 }
 
-void startPlaying(int idx) {
-    if (!ensureWifi()) return;
+// Returns false when playback has to wait for WiFi (it starts once connected)
+bool startPlaying(int idx) {
+    if (!ensureWifi()) {
+        wifiPendingPlay = idx;
+        return false;
+    }
     aPaused    = false;
+    if (playingIdx >= 0 && playingIdx != idx && playingIdx < stationCount)
+        prevStationId = stations[playingIdx].id;
     playingIdx = idx;   // Update UI immediately
     selectedIdx = idx;
     aTarget    = idx;
     aCmd       = ACMD_PLAY;  // Single atomic write - audio task handles stop+start
+    autoPlayId = "";         // a pending auto-play is superseded
     scrTitle.text = "";  // Reset scroll positions for new station
     scrGenre.text = "";
     scrSong.text  = "";
     saveLastStation();
+    if (!tFirstPlay) { tFirstPlay = millis(); bootMark("play"); }
     Serial.printf("[CMD] play(%d)\n", idx);
+    return true;
 }
 
 void stopPlaying() {
@@ -1379,6 +4234,8 @@ void saveSettings() {
     prefs.begin("somafm", false);
     prefs.putUChar("vol", volume);
     prefs.putUChar("vis", (uint8_t)visMode);
+    prefs.putBool("warm", warmOn);
+    prefs.putBool("autoplay", autoPlay);
     prefs.end();
 }
 
@@ -1386,6 +4243,14 @@ void loadSettings() {
     prefs.begin("somafm", true);
     volume  = prefs.getUChar("vol", DEFAULT_VOLUME);
     visMode = prefs.getUChar("vis", VIS_BARS);
+    warmOn  = prefs.getBool("warm", false) && WARM_SLOTS > 0;
+    autoPlay = prefs.getBool("autoplay", AUTOPLAY_DEFAULT);
+    if (autoPlay) {
+        autoPlayId  = prefs.getString("last", "");
+        pendPlayPls = prefs.getString("lastpls", "");
+        if (pendPlayPls.length() == 0) autoPlayId = "";  // saved before auto-play existed
+        pendPlayId  = autoPlayId;
+    }
     prefs.end();
     if (visMode >= VIS_COUNT) visMode = VIS_BARS;
 }
@@ -1398,18 +4263,18 @@ void cycleVisMode() {
 // ═══════════════════════════════════════════════════════════
 //  WIFI SETUP SCREENS
 // ═══════════════════════════════════════════════════════════
-void drawWifiScan() {
+void sceneWifiScan() {
     canvas.fillSprite(C_BG);
-    String hr = String(scanCount) + " found";
+    String hr = scanChannel ? String("scan ch ") + scanChannel : String(scanCount) + " found";
     drawHeader("WIFI SETUP", hr.c_str());
 
     if (scanCount == 0) {
         canvas.setTextDatum(MC_DATUM);
         canvas.setFont(&fonts::Font2);
         canvas.setTextColor(C_GRAY);
-        canvas.drawString("No networks found", SCREEN_W / 2, SCREEN_H / 2 - 8);
+        canvas.drawString(scanChannel ? "Scanning networks..." : "No networks found",
+                          SCREEN_W / 2, SCREEN_H / 2 - 8);
         drawFooter("r:Rescan");
-        canvas.pushSprite(0, 0);
         return;
     }
 
@@ -1463,7 +4328,8 @@ void drawWifiScan() {
     }
 
     // Error toast
-    if (wifiError.length() > 0 && millis() - wifiErrorTime < 3000) {
+    if (wifiError.length() > 0 && frame.ms - wifiErrorTime < 3000) {
+        uiFrameIn(3000 - (frame.ms - wifiErrorTime));   // to clear it
         int ty = SCREEN_H - FOOTER_H - 18;
         canvas.fillRect(0, ty, SCREEN_W, 16, C_HEADER2);
         canvas.setFont(&fonts::Font0);
@@ -1483,17 +4349,18 @@ void drawWifiScan() {
     canvas.setTextColor(C_GRAY);
     canvas.setTextDatum(ML_DATUM);
     int x = 4;
-    drawArrow(x + 2, cy, 0, C_GRAY); drawArrow(x + 10, cy, 1, C_GRAY);
+    drawArrow(canvas, x + 2, cy, 0, C_GRAY); drawArrow(canvas, x + 10, cy, 1, C_GRAY);
     canvas.drawString(":Nav", x + 16, cy);
     canvas.drawString("Enter:Select", 56, cy);
     canvas.drawString("r:Rescan", 148, cy);
     if (WiFi.status() == WL_CONNECTED && stationCount > 0)
         canvas.drawString("BS:Back", 204, cy);
 
-    canvas.pushSprite(0, 0);
 }
 
-void drawWifiPass() {
+void drawWifiScan() { renderFrame(sceneWifiScan); }
+
+void sceneWifiPass() {
     canvas.fillSprite(C_BG);
     drawHeader("ENTER PASSWORD");
 
@@ -1528,13 +4395,15 @@ void drawWifiPass() {
     canvas.drawString(displayText, fieldX + 4, fieldY + fieldH / 2);
 
     // Blinking cursor
-    if ((millis() / 500) % 2 == 0) {
+    uiFrameIn(UI_BLINK_MS - frame.ms % UI_BLINK_MS);
+    if ((frame.ms / UI_BLINK_MS) % 2 == 0) {
         int curX = fieldX + 4 + canvas.textWidth(displayText);
         canvas.drawFastVLine(curX, fieldY + 3, fieldH - 6, C_ACCENT);
     }
 
     // Error toast
-    if (wifiError.length() > 0 && millis() - wifiErrorTime < 3000) {
+    if (wifiError.length() > 0 && frame.ms - wifiErrorTime < 3000) {
+        uiFrameIn(3000 - (frame.ms - wifiErrorTime));
         int ty = CONTENT_Y + 68;
         canvas.fillRect(0, ty, SCREEN_W, 16, C_HEADER2);
         canvas.setFont(&fonts::Font0);
@@ -1553,9 +4422,33 @@ void drawWifiPass() {
     canvas.setTextDatum(ML_DATUM);
     canvas.drawString("Enter:Connect", 4, cy);
     canvas.drawString("BS:Back", 104, cy);
-    canvas.pushSprite(0, 0);
 }
 
+void drawWifiPass() { renderFrame(sceneWifiPass); }
+
+void sceneWifiConnect() {
+    canvas.fillSprite(C_BG);
+    canvas.setTextDatum(MC_DATUM);
+    canvas.setFont(&fonts::FreeSansBold9pt7b);
+    canvas.setTextColor(C_ACCENT);
+    canvas.drawString("SOMA FM", SCREEN_W / 2, 40);
+    canvas.setFont(&fonts::Font2);
+    canvas.setTextColor(C_WHITE);
+    canvas.drawString("Connecting...", SCREEN_W / 2, 65);
+    canvas.setTextColor(C_GRAY);
+    canvas.drawString(wifiAutoScan ? String("Looking for saved networks")
+                                   : fitText(canvas, wifiConnSSID, SCREEN_W - 20),
+                      SCREEN_W / 2, 85);
+    String dots = "";
+    for (int d = 0; d <= (int)((frame.ms / UI_BLINK_MS) % 3); d++) dots += " .";
+    uiFrameIn(UI_BLINK_MS - frame.ms % UI_BLINK_MS);
+    canvas.setTextColor(C_DARKGRAY);
+    canvas.drawString(dots, SCREEN_W / 2, 105);
+    drawFooter("BS:Cancel");
+}
+
+void drawWifiConnect() { renderFrame(sceneWifiConnect); }
+
 void handleWifiScanKeys() {
     if (!M5Cardputer.Keyboard.isChange() || !M5Cardputer.Keyboard.isPressed()) return;
     if (millis() - tLastKey < DEBOUNCE_MS) return;
@@ -1592,23 +4485,36 @@ void handleWifiScanKeys() {
     if (ks.enter && scanCount > 0) {
         wifiInputSSID = scanResults[scanSelectedIdx].ssid;
         if (scanResults[scanSelectedIdx].open) {
-            if (tryWifiConnect(wifiInputSSID, "")) {
-                saveWifiCreds(wifiInputSSID, "");
-                appState = STATE_BOOT;
-            } else {
-                wifiError = "Connection failed";
-                wifiErrorTime = millis();
-            }
+            startWifiConnect(wifiInputSSID, "", true, STATE_BOOT);
         } else {
             wifiInputPass = "";
             appState = STATE_WIFI_PASS;
         }
     }
     if (ks.del && WiFi.status() == WL_CONNECTED && stationCount > 0) {
+        stopWifiScan();
         appState = STATE_BROWSER;
     }
 }
 
+void handleWifiConnectKeys() {
+    if (!M5Cardputer.Keyboard.isChange() || !M5Cardputer.Keyboard.isPressed()) return;
+    auto ks = M5Cardputer.Keyboard.keysState();
+    if (ks.del) {
+        // Cancel: back to where the connect was started from
+        if (wifiAutoScan) WiFi.scanDelete();
+        wifiAutoScan = false;
+        WiFi.disconnect();
+        wifiPendingPlay = -1;
+        Serial.printf("[WIFI] Connect to %s cancelled\n", wifiConnSSID.c_str());
+        appState = wifiConnPrev;
+        if (appState == STATE_BOOT) {
+            startWifiScan();
+            appState = STATE_WIFI_SCAN;
+        }
+    }
+}
+
 void handleWifiPassKeys() {
     if (!M5Cardputer.Keyboard.isChange() || !M5Cardputer.Keyboard.isPressed()) return;
     if (millis() - tLastKey < DEBOUNCE_MS) return;
@@ -1625,13 +4531,7 @@ void handleWifiPassKeys() {
         return;
     }
     if (ks.enter) {
-        if (tryWifiConnect(wifiInputSSID, wifiInputPass)) {
-            saveWifiCreds(wifiInputSSID, wifiInputPass);
-            appState = STATE_BOOT;
-        } else {
-            wifiError = "Wrong password or timeout";
-            wifiErrorTime = millis();
-        }
+        startWifiConnect(wifiInputSSID, wifiInputPass, true, STATE_BOOT);
         return;
     }
     // Printable characters
@@ -1642,6 +4542,131 @@ void handleWifiPassKeys() {
     }
 }
 
+// ═══════════════════════════════════════════════════════════
+//  BATTERY MONITOR
+// ═══════════════════════════════════════════════════════════
+// The gauge used to read the battery level and charge state on every
+// header draw. Now they are sampled every BATT_SAMPLE_MS: the level is
+// smoothed (EMA) and published only when it moves BATT_HYST_PCT, and the
+// charge state only after two agreeing reads. A level point is kept every
+// BATT_SLOPE_MS; the runtime estimate extrapolates the drop over that
+// history (at least BATT_SLOPE_MIN points, reset on plug/unplug).
+#define BATT_SAMPLE_MS  5000
+#define BATT_HYST_PCT   2
+#define BATT_SLOPE_MS   120000
+#define BATT_SLOPE_N    16      // 32 min of history
+#define BATT_SLOPE_MIN  5
+
+int32_t       battEma16  = -1;   // filtered level x16
+bool          battChgRaw = false;
+unsigned long tBattSample = 0;   // last read, valid or not; 0 = never
+struct BattPoint { uint32_t ms; int16_t lvl16; };
+BattPoint battHist[BATT_SLOPE_N];
+int           battHistN = 0;
+
+void battEstimate() {
+    battMinsLeft = -1;
+    if (battCharging || battHistN < BATT_SLOPE_MIN) return;
+    const BattPoint &a = battHist[0], &b = battHist[battHistN - 1];
+    int32_t drop = a.lvl16 - b.lvl16;
+    if (drop <= 0) return;
+    battMinsLeft = (int)((uint64_t)b.lvl16 * (b.ms - a.ms) / drop / 60000);
+}
+
+void battService() {
+    // Gated on the last read alone: a gauge that keeps returning out-of-range
+    // levels is still read only every BATT_SAMPLE_MS
+    if (tBattSample && millis() - tBattSample < BATT_SAMPLE_MS) return;
+    tBattSample = millis() | 1;
+    int  raw = M5.Power.getBatteryLevel();
+    bool chg = M5.Power.isCharging();
+    if (raw < 0 || raw > 100) return;
+
+    battEma16 = battEma16 < 0 ? raw * 16 : battEma16 + (raw * 16 - battEma16) / 4;
+    int lvl = (battEma16 + 8) / 16;
+    bool first = battLevel < 0;
+    if (first || abs(lvl - battLevel) >= BATT_HYST_PCT) battLevel = lvl;
+    if (first || (chg == battChgRaw && chg != battCharging)) {
+        if (!first) Serial.printf("[BATT] %s at %d%%\n", chg ? "Charging" : "On battery", lvl);
+        battCharging = chg;
+        battHistN = 0;   // a new slope
+    }
+    battChgRaw = chg;
+
+    if (battHistN == 0 || millis() - battHist[battHistN - 1].ms >= BATT_SLOPE_MS) {
+        if (battHistN == BATT_SLOPE_N) {
+            memmove(battHist, battHist + 1, sizeof(BattPoint) * (BATT_SLOPE_N - 1));
+            battHistN--;
+        }
+        battHist[battHistN++] = {(uint32_t)millis(), (int16_t)battEma16};
+        battEstimate();
+        if (battMinsLeft >= 0)
+            Serial.printf("[BATT] %d%%, ~%d:%02d left\n", battLevel, battMinsLeft / 60,
+                          battMinsLeft % 60);
+    }
+}
+
+// ═══════════════════════════════════════════════════════════
+//  CPU FREQUENCY SCALING
+// ═══════════════════════════════════════════════════════════
+// While only streaming (screen dimmed, visualizer off) the clock drops to
+// CPU_IDLE_MHZ. Input, crossfades and a decoder that falls behind the DMA
+// (aBoostUntil) bring it back to full speed. With CONFIG_PM_ENABLE the
+// ESP-IDF power manager owns the clock and Core 1 just holds a max-freq PM
+// lock while not idle; otherwise the clock is switched directly.
+#if CPU_IDLE_MHZ && CONFIG_PM_ENABLE
+#include <esp_pm.h>
+esp_pm_lock_handle_t cpuLock = nullptr;
+#endif
+uint32_t      cpuFullMhz = 240;
+bool          cpuIdle    = false;
+unsigned long cpuIdleAt  = 0;
+uint32_t      cpuMiss0   = 0;
+
+void cpuInit() {
+    cpuFullMhz = getCpuFrequencyMhz();
+#if CPU_IDLE_MHZ && CONFIG_PM_ENABLE
+#if ESP_IDF_VERSION_MAJOR >= 5
+    esp_pm_config_t pm = {};
+#else
+    esp_pm_config_esp32s3_t pm = {};
+#endif
+    pm.max_freq_mhz = cpuFullMhz;
+    pm.min_freq_mhz = CPU_IDLE_MHZ;
+    pm.light_sleep_enable = false;
+    if (esp_pm_configure(&pm) != ESP_OK ||
+        esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "ui", &cpuLock) != ESP_OK) {
+        Serial.println("[CPU] PM unavailable, switching the clock directly");
+        cpuLock = nullptr;
+        return;
+    }
+    esp_pm_lock_acquire(cpuLock);
+#endif
+}
+
+void cpuService() {
+    bool idle = CPU_IDLE_MHZ && appState == STATE_PLAYING && aRunning && !aPaused &&
+                screenDimmed && visMode == VIS_OFF &&
+                (int32_t)(millis() - aBoostUntil) > 0;
+    if (idle == cpuIdle) return;
+    cpuIdle = idle;
+#if CPU_IDLE_MHZ && CONFIG_PM_ENABLE
+    if (cpuLock) {
+        if (idle) esp_pm_lock_release(cpuLock);
+        else      esp_pm_lock_acquire(cpuLock);
+    } else
+#endif
+    setCpuFrequencyMhz(idle ? CPU_IDLE_MHZ : cpuFullMhz);
+    if (idle) {
+        cpuIdleAt = millis();
+        cpuMiss0  = aDecodeMiss;
+        Serial.printf("[CPU] Streaming only, %u MHz\n", (unsigned)CPU_IDLE_MHZ);
+    } else {
+        Serial.printf("[CPU] Boost to %u MHz after %lu ms idle, decode misses +%u\n",
+                      cpuFullMhz, millis() - cpuIdleAt, aDecodeMiss - cpuMiss0);
+    }
+}
+
 // ═══════════════════════════════════════════════════════════
 //  INPUT HANDLING
 // ═══════════════════════════════════════════════════════════
@@ -1722,8 +4747,7 @@ void handleBrowserKeys() {
     if (ks.enter) {
         nowTrack = "";
         freeLogo();
-        startPlaying(selectedIdx);
-        appState = STATE_PLAYING;
+        if (startPlaying(selectedIdx)) appState = STATE_PLAYING;
         tLastNP  = 0;
     }
     if (hasKey(ks.word, ' ')) {
@@ -1732,13 +4756,17 @@ void handleBrowserKeys() {
         } else {
             nowTrack = "";
             freeLogo();
-            startPlaying(selectedIdx);
-            appState = STATE_PLAYING;
+            if (startPlaying(selectedIdx)) appState = STATE_PLAYING;
             tLastNP  = 0;
         }
     }
     if (hasKey(ks.word, 'f')) { toggleFavorite(selectedIdx); }
     if (hasKey(ks.word, 'n')) { startWifiScan(); appState = STATE_WIFI_SCAN; }
+    if (hasKey(ks.word, 'a')) {
+        autoPlay = !autoPlay;
+        saveSettings();
+        Serial.printf("[LAST] Auto-play on boot %s\n", autoPlay ? "on" : "off");
+    }
     if (ks.tab) { cycleVisMode(); }
     if (hasKey(ks.word, ',')) { setVolume((volume > 15) ? volume - 15 : 0); saveSettings(); }
     if (hasKey(ks.word, '/')) { setVolume((volume < 240) ? volume + 15 : 255); saveSettings(); }
@@ -1768,6 +4796,31 @@ void handlePlayerKeys() {
     }
     if (hasKey(ks.word, 'f')) { toggleFavorite(playingIdx); }
     if (hasKey(ks.word, ' ')) { aPaused = !aPaused; }
+    if (hasKey(ks.word, 'r') && sdMounted) {
+        recWant = !recWant;
+        Serial.printf("[REC] %s\n", recWant ? "Start" : "Stop");
+    }
+    if (hasKey(ks.word, 'b') && prevStationId.length()) {
+        // A/B: back to the previous station (its stream is still parked)
+        for (int i = 0; i < stationCount; i++) {
+            if (stations[i].id != prevStationId || i == playingIdx) continue;
+            selectedIdx = i;
+            nowTrack    = "";
+            freeLogo();
+            startPlaying(i);
+            tLastNP = 0;
+            break;
+        }
+    }
+    if (hasKey(ks.word, 'w') && WARM_SLOTS > 0) {
+        warmOn = !warmOn;
+        saveSettings();
+        Serial.printf("[WARM] Standby %s\n", warmOn ? "on" : "off");
+    }
+    if (hasKey(ks.word, 'l') && tsWant != 0) {
+        // Drop the time-shift ring and rejoin the live stream
+        startPlaying(playingIdx);
+    }
     if (ks.tab) { cycleVisMode(); }
     if (hasKey(ks.word, ',')) { setVolume((volume > 15) ? volume - 15 : 0); saveSettings(); }
     if (hasKey(ks.word, '/')) { setVolume((volume < 240) ? volume + 15 : 255); saveSettings(); }
@@ -1795,10 +4848,43 @@ void handleErrorKeys() {
     if (ks.enter) { appState = STATE_BOOT; }
 }
 
+// Everything a screen shows that can change without a key press (other
+// tasks, network, timers) folded into one word; loop() redraws when it
+// changes.
+uint32_t uiStateHash() {
+    uint32_t h = 2166136261u;
+    auto mix = [&h](uint32_t v) { h = (h ^ v) * 16777619u; };
+    mix(appState); mix(selectedIdx); mix(scrollOffset); mix(playingIdx);
+    mix(stationCount); mix(volume); mix(visMode); mix(battLevel); mix(battCharging);
+    mix(aRunning); mix(aPaused); mix(recWant); mix(warmOn); mix(autoPlay);
+    mix(logoValid); mix(logoForIdx); mix(tsLagSeconds()); mix(thumbSeq);
+    for (unsigned i = 0; i < nowTrack.length(); i++) mix(nowTrack[i]);
+    mix(scanCount); mix(scanSelectedIdx); mix(scanScrollOff); mix(scanChannel);
+    mix(wifiAutoScan); mix(wifiInputPass.length()); mix(wifiError.length());
+    return h;
+}
+
 // ═══════════════════════════════════════════════════════════
 //  SETUP
 // ═══════════════════════════════════════════════════════════
+// One-shot task: mounting the card (slow to time out when there is none)
+// stays off the path to the browser; the recording writer starts here
+void sdMountTask(void *) {
+    sdSPI.begin(40, 39, 14, 12);  // SCK=40 MISO=39 MOSI=14 CS=12
+    bool ok = SD.begin(12, sdSPI, 25000000);
+    if (ok) {
+        recFreeQ = xQueueCreate(REC_BLOCKS, sizeof(uint8_t *));
+        recFullQ = xQueueCreate(REC_BLOCKS + 4, sizeof(RecMsg));
+        xTaskCreatePinnedToCore(recWriterTask, "recwr", 6144, nullptr, 1, nullptr, 1);
+    }
+    sdMounted = ok;
+    bootMark("sd");
+    Serial.printf("[FS] SD card %s\n", ok ? "mounted" : "not present");
+    vTaskDelete(nullptr);
+}
+
 void setup() {
+    tSetup = millis();   // before display and codec bring-up, so boot figures include them
     auto cfg = M5.config();
     M5Cardputer.begin(cfg);
 
@@ -1808,26 +4894,31 @@ void setup() {
     // Display
     M5.Display.setRotation(1);
     M5.Display.setBrightness(80);
-    canvas.createSprite(SCREEN_W, SCREEN_H);
+    M5.Display.initDMA();
+    if (!bandsBegin()) Serial.println("[UI] Band buffer alloc FAILED");
 
     // Show splash immediately
-    canvas.fillSprite(C_BG);
-    canvas.setTextDatum(MC_DATUM);
-    canvas.setFont(&fonts::FreeSansBold9pt7b);
-    canvas.setTextColor(C_ACCENT);
-    canvas.drawString("SOMA FM", SCREEN_W / 2, 50);
-    canvas.setFont(&fonts::Font0);
-    canvas.setTextColor(C_DARKGRAY);
-    canvas.drawString("Starting...", SCREEN_W / 2, 80);
-    canvas.pushSprite(0, 0);
+    renderFrame([] {
+        canvas.fillSprite(C_BG);
+        canvas.setTextDatum(MC_DATUM);
+        canvas.setFont(&fonts::FreeSansBold9pt7b);
+        canvas.setTextColor(C_ACCENT);
+        canvas.drawString("SOMA FM", SCREEN_W / 2, 50);
+        canvas.setFont(&fonts::Font0);
+        canvas.setTextColor(C_DARKGRAY);
+        canvas.drawString("Starting...", SCREEN_W / 2, 80);
+    });
+    bootMark("splash");
 
     // Start WiFi early (non-blocking) if we have stored credentials
     WiFi.mode(WIFI_STA);
+    WiFi.onEvent(onWifiEvent);
     String storedSSID = loadWifiSSID();
     if (storedSSID.length() > 0) {
         String storedPass = loadWifiPass();
-        WiFi.begin(storedSSID.c_str(), storedPass.c_str());
+        wifiBegin(storedSSID, storedPass, true);
     }
+    bootMark("wifi begin");
 
     // Persistent flash cache for channels + logos
     if (!LittleFS.begin(true)) {
@@ -1835,27 +4926,38 @@ void setup() {
     } else {
         Serial.println("[FS] LittleFS mounted");
         if (!LittleFS.exists("/logos")) LittleFS.mkdir("/logos");
+        LittleFS.remove(TS_PATH);  // stale time-shift ring from a reset
+        if (BROWSER_THUMBS) {
+            thumbQ = xQueueCreate(MAX_STATIONS, sizeof(ThumbJob));
+            xTaskCreatePinnedToCore(thumbTask, "thumbs", 6144, nullptr, 0, nullptr, 1);
+        }
     }
+    bootMark("littlefs");
 
-    // Release M5.Speaker's I2S port so we can drive it directly
-    M5.Speaker.end();
-    delay(100);
+    // Optional microSD card, mounted in the background
+    xTaskCreatePinnedToCore(sdMountTask, "sdmount", 4096, nullptr, 1, nullptr, 1);
 
-    // Direct I2S output to ES8311 on port 1 (Cardputer ADV: bck=41, ws=43, dout=42)
+    // Direct I2S output to ES8311 on port 1 (Cardputer ADV: bck=41, ws=43,
+    // dout=42); the audio task brings it up
     audioOut = new DirectI2SOutput(I2S_NUM_1, 41, 43, 42);
-    audioOut->begin();
-
-    // Re-initialize ES8311 DAC registers
-    es8311_init_dac();
 
     // Restore saved volume and visualizer mode
     loadSettings();
     audioOut->SetGain((float)volume / 200.0f);
-    Serial.printf("[SETUP] DirectI2S on port 1, ES8311 init, vol=%d vis=%d\n", volume, visMode);
+    Serial.printf("[SETUP] vol=%d vis=%d\n", volume, visMode);
 
     // Launch audio task on Core 0
+    streamLock = xSemaphoreCreateMutex();
+    warmLock   = xSemaphoreCreateMutex();
+    netJobQ    = xQueueCreate(2, sizeof(NetJob));
+    netDoneQ   = xQueueCreate(2, sizeof(NetDone));
+    cpuInit();
     xTaskCreatePinnedToCore(audioTask, "audio", 16384, nullptr, 2, &audioTaskH, 0);
+    xTaskCreatePinnedToCore(netTask, "net", 10240, nullptr, 1, nullptr, 0);
+    if (TIMESHIFT_KB > 0)
+        xTaskCreatePinnedToCore(tsTask, "tshift", 6144, nullptr, 1, nullptr, 1);
 
+    bootMark("setup done");
     Serial.printf("[SETUP] Ready, heap=%u\n", ESP.getFreeHeap());
 }
 
@@ -1863,7 +4965,20 @@ void setup() {
 //  MAIN LOOP  (runs on Core 1)
 // ═══════════════════════════════════════════════════════════
 void loop() {
-    M5Cardputer.update();
+    // The ADV keyboard shares In_I2C with the codec the audio task is
+    // still configuring
+    if (aHwReady) {
+        M5Cardputer.update();
+        if (M5Cardputer.Keyboard.isChange()) {
+            uiInvalidate();
+            if (M5Cardputer.Keyboard.isPressed() && !uiKeyWait) {
+                uiKeyWait = true;
+                uiKeyUs   = micros();
+            }
+        }
+    }
+    uiPollTick();
+    serialService();
 
     // ── Boot sequence ──
     if (appState == STATE_BOOT) {
@@ -1875,23 +4990,23 @@ void loop() {
             return;
         }
 
-        // Have creds — try cache for instant boot
+        // Have creds — try cache for instant boot (WiFi is still associating)
         if (loadCachedChannels()) {
             Serial.printf("[BOOT] Cached %d stations\n", stationCount);
+            bootMark("cache parsed");
             loadFavorites();
             sortStations();
             restoreLastStation();
+            thumbPlan();
             appState = STATE_BROWSER;
+            bootMark("browser");
             needsRefresh = true;  // refresh from network in background
             return;
         }
 
-        // No cache — need network now
-        if (!tryWifiConnect(storedSSID, loadWifiPass())) {
-            wifiError = "Saved network failed";
-            wifiErrorTime = millis();
-            startWifiScan();
-            appState = STATE_WIFI_SCAN;
+        // No cache — need network now (boot resumes here once connected)
+        if (WiFi.status() != WL_CONNECTED) {
+            startWifiAuto(STATE_BOOT);
             return;
         }
         if (!fetchChannels()) {
@@ -1902,10 +5017,26 @@ void loop() {
         loadFavorites();
         sortStations();
         restoreLastStation();
+        thumbPlan();
         appState = STATE_BROWSER;
+        bootMark("browser");
+    }
+
+    // ── Auto-play: attach the station the audio task started to the list ──
+    if (autoPlayId.length() && stationCount > 0 && bootPlaying) {
+        for (int i = 0; i < stationCount && playingIdx < 0; i++) {
+            if (stations[i].id != autoPlayId) continue;
+            playingIdx = selectedIdx = i;
+            ensureVisible();
+            nowTrack = "";
+            tLastNP  = 0;
+            appState = STATE_PLAYING;
+        }
+        autoPlayId = "";
     }
 
     // ── Deferred network refresh (non-blocking — only when WiFi ready) ──
+    static bool refreshFallback = false;
     if (needsRefresh) {
         if (WiFi.status() == WL_CONNECTED) {
             needsRefresh = false;
@@ -1914,33 +5045,88 @@ void loop() {
                 loadFavorites();
                 sortStations();
                 restoreLastStation();
+                thumbPlan();
+                uiInvalidate();   // listener counts, order
                 Serial.println("[REFRESH] Updated from network");
             }
-        } else if (millis() > 15000) {
-            // WiFi hasn't connected after 15s — stored creds likely bad
-            needsRefresh = false;
-            Serial.println("[REFRESH] WiFi timeout — showing scan screen");
-            startWifiScan();
-            appState = STATE_WIFI_SCAN;
+        } else if (millis() > 15000 && !refreshFallback) {
+            // Last-used network hasn't connected after 15s — try the other
+            // saved networks (WiFi setup opens if none is in range); the
+            // refresh runs once one connects
+            refreshFallback = true;
+            Serial.println("[REFRESH] WiFi timeout — trying saved networks");
+            startWifiAuto(appState, true);
             return;
         }
     }
 
+    // ── WiFi scan / connect progress (never blocks) ──
+    serviceWifiFast();
+    serviceWifiScan();
+    serviceWifiRoam();
+    if (appState == STATE_WIFI_CONNECT) serviceWifiConnect();
+
     // ── Input ──
+    // Ctrl+D toggles the debug overlay on any screen (and is not passed on)
+    if (aHwReady && M5Cardputer.Keyboard.isChange() && M5Cardputer.Keyboard.isPressed()) {
+        auto ks = M5Cardputer.Keyboard.keysState();
+        if (ks.ctrl && hasKey(ks.word, 'd')) {
+            uiDebug = !uiDebug;
+            Serial.printf("[UI] Debug overlay %s\n", uiDebug ? "on" : "off");
+            uiInvalidate();
+            return;
+        }
+    }
     switch (appState) {
         case STATE_WIFI_SCAN: handleWifiScanKeys(); break;
         case STATE_WIFI_PASS: handleWifiPassKeys(); break;
+        case STATE_WIFI_CONNECT: handleWifiConnectKeys(); break;
         case STATE_BROWSER:   handleBrowserKeys();  break;
         case STATE_PLAYING:   handlePlayerKeys();   break;
         case STATE_ERROR:     handleErrorKeys();    break;
         default: break;
     }
 
+    // ── Boot timing, once the first audio has reached I2S ──
+    static bool bootTimed = false;
+    if (!bootTimed && tFirstAudio) {
+        bootTimed = true;
+        uint32_t up = tWifiUp ? tWifiUp : tFirstPlay;
+        Serial.printf("[BOOT] setup@%u ms, WiFi +%u ms, play +%u ms, first audio +%u ms "
+                      "(WiFi to audio %u ms)\n", tSetup, up - tSetup,
+                      tFirstPlay - tSetup, tFirstAudio - tSetup,
+                      tFirstAudio - max(up, tFirstPlay));
+        portENTER_CRITICAL(&bootMux);
+        if (bootMarkN < BOOT_MARKS) bootMarks[bootMarkN++] = {"first audio", tFirstAudio};
+        portEXIT_CRITICAL(&bootMux);
+        uint32_t prev = 0;
+        for (uint32_t i = 0; i < bootMarkN; i++) {
+            Serial.printf("[BOOT] %6u ms (+%4u) %s\n", bootMarks[i].ms,
+                          bootMarks[i].ms - prev, bootMarks[i].name);
+            prev = bootMarks[i].ms;
+        }
+    }
+
+    // ── In-stream ICY title: show track changes immediately ──
+    static uint32_t icySeen = 0;
+    if (icySeq != icySeen) {
+        icySeen = icySeq;
+        char t[sizeof(icyTitle)];
+        portENTER_CRITICAL(&icyMux);
+        strlcpy(t, icyTitle, sizeof(t));
+        portEXIT_CRITICAL(&icyMux);
+        if (t[0]) nowTrack = t;
+    }
+
     // ── Periodic: fetch now-playing info ──
     if (appState == STATE_PLAYING && playingIdx >= 0) {
         if (millis() - tLastNP > NP_MS || tLastNP == 0) {
             tLastNP = millis();
+            String before = nowTrack;
             fetchNowPlaying();
+            // Streams without ICY titles split recordings on song API changes
+            if (recOn && !icyActive && before.length() > 0 && nowTrack != before)
+                recRequestSplit(nowTrack.c_str());
         }
         // Download logo if not yet cached
         if (logoForIdx != playingIdx) {
@@ -1955,16 +5141,32 @@ void loop() {
         screenDimmed = true;
     }
 
-    // ── UI redraw ──
-    if (millis() - tLastUI > UI_MS) {
-        tLastUI = millis();
+    battService();
+    cpuService();
+
+    // ── UI redraw (only when invalidated or an animation is due) ──
+    static uint32_t uiSeen = 0;
+    uint32_t uiNow = uiStateHash();
+    if (uiNow != uiSeen) {
+        uiSeen = uiNow;
+        uiInvalidate();
+    }
+    if (uiFrameDue()) {
         switch (appState) {
             case STATE_WIFI_SCAN: drawWifiScan(); break;
             case STATE_WIFI_PASS: drawWifiPass(); break;
+            case STATE_WIFI_CONNECT: drawWifiConnect(); break;
             case STATE_BROWSER:   drawBrowser();  break;
             case STATE_PLAYING:   drawPlayer();   break;
             case STATE_ERROR:     drawError();    break;
             default: break;
         }
     }
+    uiProfReport();
+    uiFpmService();
+
+    // Nothing due: sleep instead of spinning, still polling keys every
+    // UI_POLL_MS
+    long wait = uiDue ? (long)(uiDueAt - millis()) : (long)UI_POLL_MS;
+    if (wait > 0) delay(min(wait, (long)UI_POLL_MS));
 }
@@ -0,0 +1,103 @@
+// fitText() on the host, before and after the advance table: SomaFM
+// channel titles truncated to the browser row and two narrower widths.
+// textWidth() is a stub summing a Font2-like advance table, so only the
+// search and allocations differ; the device call also walks the font's
+// glyph data, so the "before" numbers understate its cost. The memo in
+// front of fitText() is left out: this is the cost of a miss.
+#include <string>
+#include "check.h"
+#include "textfit.h"
+
+static const char *titles[] = {
+    "Groove Salad", "Groove Salad Classic", "Drone Zone", "Deep Space One",
+    "Space Station Soma", "Secret Agent", "Lush", "Fluid",
+    "Illinois Street Lounge", "Indie Pop Rocks!", "Underground 80s",
+    "Boot Liquor", "Left Coast 70s", "Sonic Universe", "DEF CON Radio",
+    "Suburbs of Goa", "Beat Blender", "cliqhop idm", "Dub Step Beyond",
+    "Digitalis", "Folk Forward", "Heavyweight Reggae", "Metal Detector",
+    "PopTron", "Seven Inch Soul", "ThistleRadio", "The Trip", "Vaporwaves",
+    "Mission Control", "Bossa Beyond", "Synphaera Radio", "n5MD Radio",
+    "Black Rock FM", "Doomed", "Covers", "SF 10-33", "SF Police Scanner",
+    "The Dark Zone", "Chillits Radio", "Tiki Time", "Christmas Lounge",
+    "Xmas in Frisko", "Jolly Ol' Soul", "Christmas Rocks!",
+};
+static const int widths[] = { 174, 120, 60 };   // row title, then narrower
+#define N_TITLES (int)(sizeof(titles) / sizeof(titles[0]))
+#define N_WIDTHS (int)(sizeof(widths) / sizeof(widths[0]))
+
+static uint8_t adv[95];
+static uint64_t widthCalls;
+
+static int textWidth(const std::string &s) {   // stub for M5Canvas::textWidth
+    widthCalls++;
+    int w = 0;
+    for (unsigned char ch : s) w += (ch >= 32 && ch <= 126) ? adv[ch - 32] : 8;
+    return w;
+}
+
+// As fitText() was: measure, then every shorter candidate from the longest
+static std::string fitBefore(const std::string &s, int maxPx) {
+    if (textWidth(s) <= maxPx) return s;
+    for (int len = (int)s.length() - 1; len > 0; len--) {
+        std::string t = s.substr(0, len) + "~";
+        if (textWidth(t) <= maxPx) return t;
+    }
+    return "~";
+}
+
+// As fitText() is on a memo miss
+static std::string fitAfter(const std::string &s, int maxPx) {
+    int n = s.length();
+    uint16_t pre[129];
+    bool table = n <= 128 && prefixWidths(s.c_str(), n, adv, pre);
+    auto width = [&](int len) -> int { return table ? pre[len] : textWidth(s.substr(0, len)); };
+    if (width(n) <= maxPx) return s;
+    int lo = fitPrefixLen(n, maxPx, textWidth("~"), width);
+    return lo > 0 ? s.substr(0, lo) + "~" : std::string("~");
+}
+
+static volatile size_t sink;
+
+template <typename F>
+static double timeNs(F fit, int reps, double &calls) {
+    widthCalls = 0;
+    uint64_t t0 = hostNanos();
+    for (int r = 0; r < reps; r++)
+        for (int w : widths)
+            for (const char *t : titles) sink = fit(std::string(t), w).size();
+    uint64_t n = (uint64_t)reps * N_WIDTHS * N_TITLES;
+    calls = (double)widthCalls / n;
+    return (double)(hostNanos() - t0) / n;
+}
+
+int main() {
+    // Font2-like advances: narrow punctuation, wide capitals
+    for (int ch = 32; ch < 127; ch++) {
+        int w = 7;
+        if (ch == ' ' || ch == '!' || ch == '\'' || ch == '.' || ch == ',') w = 3;
+        else if (ch == 'i' || ch == 'l' || ch == 'j' || ch == 't' || ch == 'f') w = 4;
+        else if (ch >= 'A' && ch <= 'Z') w = (ch == 'M' || ch == 'W') ? 11 : 9;
+        else if (ch == 'm' || ch == 'w') w = 10;
+        adv[ch - 32] = w;
+    }
+
+    int truncated = 0;
+    for (int w : widths)
+        for (const char *t : titles) {
+            std::string a = fitBefore(t, w), b = fitAfter(t, w);
+            CHECK(a == b);
+            truncated += a != t;
+        }
+
+    const int reps = 2000;
+    double callsBefore, callsAfter;
+    double before = timeNs(fitBefore, reps, callsBefore);
+    double after  = timeNs(fitAfter, reps, callsAfter);
+    CHECK(after < before);
+
+    printf("  %d titles x %d widths, %d truncated\n", N_TITLES, N_WIDTHS, truncated);
+    printf("  before: %.0f ns/call, %.1f textWidth calls/call\n", before, callsBefore);
+    printf("  after:  %.0f ns/call, %.1f textWidth calls/call (%.1fx faster)\n", after,
+           callsAfter, before / after);
+    return checkReport("bench_fittext");
+}
@@ -0,0 +1,153 @@
+// Recording tee on the host: the BlockTee path recFeed() runs on the audio
+// task, with a writer thread standing in for recWriterTask and a temp file
+// for the SD card. Queues are bounded and the feed side never waits, as
+// with recFreeQ/recFullQ (timeout 0).
+//   sustained   feed as fast as the writer drains, report MB/s and the
+//               worst single block write
+//   stall       feed at 320 kbps while the "card" stalls; the pool covers
+//               a short stall with no loss, a long one costs counted bytes,
+//               and the feed's worst call stays in microseconds either way
+#include <unistd.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include "check.h"
+#include "recblocks.h"
+
+#define REC_BLOCK_SIZE 4096
+#define REC_BLOCKS     6
+#define READ_LEN       1024   // bytes per recFeed() call
+
+template <typename T>
+struct HostQueue {   // bounded, like xQueueCreate(cap, sizeof(T))
+    std::mutex m;
+    std::condition_variable cv;
+    std::deque<T> q;
+    size_t cap;
+    explicit HostQueue(size_t c) : cap(c) {}
+    bool trySend(const T &v) {
+        std::lock_guard<std::mutex> l(m);
+        if (q.size() >= cap) return false;
+        q.push_back(v);
+        cv.notify_one();
+        return true;
+    }
+    bool tryReceive(T &v) {
+        std::lock_guard<std::mutex> l(m);
+        if (q.empty()) return false;
+        v = q.front();
+        q.pop_front();
+        return true;
+    }
+    T receive() {
+        std::unique_lock<std::mutex> l(m);
+        cv.wait(l, [this] { return !q.empty(); });
+        T v = q.front();
+        q.pop_front();
+        return v;
+    }
+    size_t size() {
+        std::lock_guard<std::mutex> l(m);
+        return q.size();
+    }
+};
+
+struct Msg { uint8_t *blk; uint32_t len; };   // blk == nullptr: stop
+
+static HostQueue<uint8_t *> freeQ(REC_BLOCKS);
+static HostQueue<Msg>       fullQ(REC_BLOCKS + 4);
+
+static uint8_t *takeBlock() {
+    uint8_t *b;
+    return freeQ.tryReceive(b) ? b : nullptr;
+}
+static bool giveBlock(uint8_t *blk, uint32_t len) { return fullQ.trySend({ blk, len }); }
+
+struct Run {
+    uint64_t fed = 0, written = 0, dropped = 0;
+    uint64_t feedWorstNs = 0, writeWorstNs = 0, wallNs = 0;
+};
+
+// stallMs > 0: every stallEveryMs the next block write takes stallMs longer
+static Run runOnce(uint64_t bytes, uint32_t kbps, uint32_t stallMs, uint32_t stallEveryMs) {
+    static uint8_t pool[REC_BLOCK_SIZE * REC_BLOCKS];
+    for (int i = 0; i < REC_BLOCKS; i++) freeQ.trySend(pool + i * REC_BLOCK_SIZE);
+    FILE *f = tmpfile();
+    Run r;
+
+    std::thread writer([&] {
+        uint64_t lastStall = hostNanos();
+        for (;;) {
+            Msg m = fullQ.receive();
+            if (!m.blk) break;
+            uint64_t t0 = hostNanos();
+            if (stallMs && t0 - lastStall >= stallEveryMs * 1000000ull) {
+                usleep(stallMs * 1000);
+                lastStall = hostNanos();
+            }
+            fwrite(m.blk, 1, m.len, f);
+            fflush(f);
+            uint64_t dt = hostNanos() - t0;
+            if (dt > r.writeWorstNs) r.writeWorstNs = dt;
+            r.written += m.len;
+            freeQ.trySend(m.blk);
+        }
+    });
+
+    BlockTee tee(REC_BLOCK_SIZE, takeBlock, giveBlock);
+    uint8_t chunk[READ_LEN];
+    uint64_t start = hostNanos();
+    uint64_t perChunkNs = kbps ? (uint64_t)READ_LEN * 8 * 1000000 / kbps : 0;
+    for (uint64_t off = 0; off < bytes; off += READ_LEN) {
+        if (kbps) {   // real-time pacing
+            uint64_t due = start + (off / READ_LEN) * perChunkNs;
+            while (hostNanos() < due) usleep(200);
+        } else {      // sustained: keep the writer busy, never drop
+            while (freeQ.size() == 0 && !tee.cur) std::this_thread::yield();
+        }
+        for (int i = 0; i < READ_LEN; i++) chunk[i] = (uint8_t)(off + i);
+        uint64_t t0 = hostNanos();
+        tee.feed(chunk, READ_LEN);
+        uint64_t dt = hostNanos() - t0;
+        if (dt > r.feedWorstNs) r.feedWorstNs = dt;
+        r.fed += READ_LEN;
+    }
+    tee.flush();
+    if (tee.cur) freeQ.trySend(tee.cur);
+    while (!fullQ.trySend({ nullptr, 0 })) usleep(1000);
+    writer.join();
+    fsync(fileno(f));
+    r.wallNs  = hostNanos() - start;
+    r.dropped = tee.dropped;
+    fclose(f);
+    uint8_t *b;
+    while (freeQ.tryReceive(b)) {}
+    return r;
+}
+
+int main() {
+    // Sustained: 32 MB through the pool as fast as the file takes it
+    Run s = runOnce(32u << 20, 0, 0, 0);
+    CHECK(s.dropped == 0);
+    CHECK(s.written == s.fed);
+    printf("  sustained: %.1f MB/s (%llu MB, %u x %u B blocks), worst block write %.2f ms\n",
+           s.written / 1048576.0 / (s.wallNs / 1e9), (unsigned long long)(s.written >> 20),
+           REC_BLOCKS, REC_BLOCK_SIZE, s.writeWorstNs / 1e6);
+
+    // 320 kbps for 3 s; the pool holds 24 KB = 600 ms
+    Run a = runOnce(3 * 40000, 320, 300, 1000);
+    CHECK(a.dropped == 0);
+    CHECK(a.written == a.fed);
+    CHECK(a.feedWorstNs < 5000000);
+    printf("  320 kbps, 300 ms card stall each second: feed worst %.1f us, write worst %.0f ms, dropped %llu B\n",
+           a.feedWorstNs / 1e3, a.writeWorstNs / 1e6, (unsigned long long)a.dropped);
+
+    Run b = runOnce(3 * 40000, 320, 1500, 1000);
+    CHECK(b.dropped > 0);
+    CHECK(b.written + b.dropped == b.fed);
+    CHECK(b.feedWorstNs < 5000000);
+    printf("  320 kbps, 1500 ms card stall:             feed worst %.1f us, write worst %.0f ms, dropped %llu B\n",
+           b.feedWorstNs / 1e3, b.writeWorstNs / 1e6, (unsigned long long)b.dropped);
+    return checkReport("bench_rec");
+}
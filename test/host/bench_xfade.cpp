@@ -0,0 +1,83 @@
+// Crossfade mix cost and heap on the host: the MonoRing/FadeRamp path the
+// audio task runs per output sample while two decoders overlap. The
+// outgoing "decoder" refills the ring one 1152-sample MP3 frame at a time
+// when it runs dry, as MixVoice does. Decoder cost itself is not included
+// (the device logs it as "outgoing decode" in [XFADE]).
+#include <malloc.h>
+#include <math.h>
+#include "check.h"
+#include "xfade.h"
+
+#define XF_RING_N 2048
+#define RATE      44100
+#define FRAME     1152
+
+static size_t heapUsed() { return mallinfo2().uordblks; }
+
+static volatile int32_t sink;
+
+int main() {
+    const uint32_t fadeMs = 500, n = (uint32_t)((uint64_t)RATE * fadeMs / 1000);
+    const int reps = 200;
+    int16_t frameL[FRAME], frameR[FRAME];
+    for (int i = 0; i < FRAME; i++) {
+        frameL[i] = (int16_t)(12000 * sin(i * 0.031));
+        frameR[i] = (int16_t)(12000 * sin(i * 0.029));
+    }
+
+    // Plain output path: stereo to mono and gain, no fade
+    uint64_t t0 = hostNanos();
+    for (int r = 0; r < reps; r++)
+        for (uint32_t i = 0; i < n; i++) {
+            int16_t raw = ((int32_t)frameL[i % FRAME] + frameR[i % FRAME]) / 2;
+            sink = ((int32_t)raw * 64) >> 6;
+        }
+    double plainNs = (double)(hostNanos() - t0) / ((double)reps * n);
+
+    // Fade path: ring refill, pop, ramp mix
+    size_t heap0 = heapUsed(), heapPeak = 0;
+    MonoRing<XF_RING_N> ring;
+    FadeRamp ramp;
+    CHECK(ring.alloc());
+    heapPeak = heapUsed() - heap0;
+    bool startOk = true, endOk = true, monotonic = true;
+    t0 = hostNanos();
+    for (int r = 0; r < reps; r++) {
+        ring.clear();
+        ramp.start(n);
+        int32_t lastGain = -1;
+        for (uint32_t i = 0; !ramp.done(); i++) {
+            int16_t in = ((int32_t)frameL[i % FRAME] + frameR[i % FRAME]) / 2;
+            int16_t old = 0;
+            if (!ring.pop(old)) {
+                for (int k = 0; k < FRAME; k++)
+                    ring.push(((int32_t)frameL[k] + frameR[k]) / 2);
+                ring.pop(old);
+            }
+            int32_t g = ramp.gain >> 16;
+            if (g < lastGain) monotonic = false;
+            lastGain = g;
+            int16_t m = ramp.mix(in, old);
+            if (i == 0) startOk = startOk && abs(m - old) <= 1;
+            if (ramp.done()) endOk = endOk && abs(m - in) <= 2;
+            sink = m;
+        }
+        size_t h = heapUsed() - heap0;
+        if (h > heapPeak) heapPeak = h;
+    }
+    double fadeNs = (double)(hostNanos() - t0) / ((double)reps * n);
+    free(ring.buf);
+
+    CHECK(startOk);
+    CHECK(endOk);
+    CHECK(monotonic);
+    CHECK(heapPeak <= XF_RING_N * sizeof(int16_t) + 64);
+
+    double periodNs = 1e9 / RATE;
+    printf("  %u ms fade = %u samples, %d runs\n", fadeMs, n, reps);
+    printf("  output path, no fade: %.2f ns/sample\n", plainNs);
+    printf("  with fade mix:        %.2f ns/sample (+%.2f ns, %.3f%% of the %.1f us sample period)\n",
+           fadeNs, fadeNs - plainNs, (fadeNs - plainNs) * 100 / periodNs, periodNs / 1000);
+    printf("  mix path peak heap:   %zu B (ring %u samples)\n", heapPeak, XF_RING_N);
+    return checkReport("bench_xfade");
+}
@@ -0,0 +1,27 @@
+#pragma once
+// Minimal assertion helpers for the host tests (no test framework needed)
+#include <stdio.h>
+#include <stdint.h>
+#include <chrono>
+
+static int checkFails = 0;
+
+#define CHECK(c) do { \
+    if (!(c)) { printf("  FAIL %s:%d: %s\n", __FILE__, __LINE__, #c); checkFails++; } \
+} while (0)
+
+static inline uint32_t hostMillis() {
+    using namespace std::chrono;
+    static const steady_clock::time_point t0 = steady_clock::now();
+    return (uint32_t)duration_cast<milliseconds>(steady_clock::now() - t0).count();
+}
+
+static inline uint64_t hostNanos() {
+    using namespace std::chrono;
+    return (uint64_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static inline int checkReport(const char *name) {
+    printf("%s: %s\n", name, checkFails ? "FAILED" : "ok");
+    return checkFails ? 1 : 0;
+}
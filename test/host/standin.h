@@ -0,0 +1,148 @@
+#pragma once
+// Local stand-in for an Icecast relay on 127.0.0.1, one thread per server.
+//   OK      answers "ICY 200 OK" at once, then streams at kbps
+//   SLOW    answers after delayMs
+//   HANG    accepts and reads the request but never answers
+//   REFUSE  nothing listens on the port (connection refused)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Byte k of every stand-in stream
+static inline uint8_t standInByte(uint64_t k) {
+    return (uint8_t)(k ^ (k >> 8) ^ (k >> 16) ^ (k >> 24));
+}
+
+class StandIn {
+public:
+    enum Mode { OK, SLOW, HANG, REFUSE };
+
+    StandIn(Mode mode, uint32_t delayMs = 0, uint32_t kbps = 128)
+        : _mode(mode), _delayMs(delayMs), _kbps(kbps) {
+        _fd = socket(AF_INET, SOCK_STREAM, 0);
+        int one = 1;
+        setsockopt(_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in a = {};
+        a.sin_family      = AF_INET;
+        a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(_fd, (sockaddr *)&a, sizeof(a));
+        socklen_t len = sizeof(a);
+        getsockname(_fd, (sockaddr *)&a, &len);
+        _port = ntohs(a.sin_port);
+        if (mode == REFUSE) {   // keep the port number, free the socket
+            close(_fd);
+            _fd = -1;
+            return;
+        }
+        listen(_fd, 8);
+        _thread = std::thread([this] { serve(); });
+    }
+
+    ~StandIn() {
+        _stop = true;
+        if (_thread.joinable()) _thread.join();
+        if (_fd >= 0) close(_fd);
+    }
+
+    std::string url(const char *mount = "groovesalad-128-mp3") const {
+        return "http://127.0.0.1:" + std::to_string(_port) + "/" + mount;
+    }
+    uint64_t sent() const { return _sent; }
+
+private:
+    void serve() {
+        std::vector<std::thread> conns;
+        while (!_stop) {
+            pollfd p = { _fd, POLLIN, 0 };
+            if (poll(&p, 1, 20) <= 0) continue;
+            int c = accept(_fd, nullptr, nullptr);
+            if (c >= 0) conns.emplace_back([this, c] { client(c); });
+        }
+        for (auto &t : conns) t.join();
+    }
+
+    bool sleepMs(uint32_t ms) {
+        for (uint32_t t = 0; t < ms && !_stop; t += 5) usleep(5000);
+        return !_stop;
+    }
+
+    void client(int c) {
+        char req[512];
+        recv(c, req, sizeof(req), 0);
+        if (_mode == HANG) {
+            while (sleepMs(20)) {}
+        } else if (_mode != SLOW || sleepMs(_delayMs)) {
+            const char *hdr = "ICY 200 OK\r\nicy-name:stand-in\r\n"
+                              "content-type:audio/mpeg\r\n\r\n";
+            send(c, hdr, strlen(hdr), MSG_NOSIGNAL);
+            // Payload is standInByte(offset), so a reader can check order
+            uint8_t buf[418];
+            uint64_t off = 0;
+            uint32_t perTick = _kbps * 125 / 50;   // 20 ms ticks
+            uint32_t owed = 0;
+            while (sleepMs(20)) {
+                owed += perTick;
+                while (owed >= sizeof(buf)) {
+                    for (size_t i = 0; i < sizeof(buf); i++) buf[i] = standInByte(off + i);
+                    if (send(c, buf, sizeof(buf), MSG_NOSIGNAL) <= 0) goto done;
+                    off   += sizeof(buf);
+                    _sent += sizeof(buf);
+                    owed  -= sizeof(buf);
+                }
+            }
+        }
+    done:
+        close(c);
+    }
+
+    Mode     _mode;
+    uint32_t _delayMs, _kbps;
+    int      _fd   = -1;
+    int      _port = 0;
+    std::atomic<bool>     _stop{false};
+    std::atomic<uint64_t> _sent{0};
+    std::thread _thread;
+};
+
+// Minimal ICY client: connect, GET, wait for the status line. Returns the
+// socket (>= 0) when the server answered 200 within timeoutMs, else -1.
+static inline int standInOpen(const std::string &url, uint32_t timeoutMs) {
+    size_t h = url.find("//") + 2;
+    size_t c = url.find(':', h);
+    size_t s = url.find('/', c);
+    int port = atoi(url.substr(c + 1, s - c - 1).c_str());
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in a = {};
+    a.sin_family      = AF_INET;
+    a.sin_port        = htons(port);
+    a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, (sockaddr *)&a, sizeof(a)) != 0) { close(fd); return -1; }
+    std::string req = "GET " + url.substr(s) + " HTTP/1.0\r\nIcy-MetaData: 1\r\n\r\n";
+    send(fd, req.data(), req.size(), MSG_NOSIGNAL);
+    auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    char line[8] = {};
+    size_t got = 0;
+    while (got < 7) {
+        int left = (int)std::chrono::duration_cast<std::chrono::milliseconds>(
+                       until - std::chrono::steady_clock::now()).count();
+        pollfd p = { fd, POLLIN, 0 };
+        if (left <= 0 || poll(&p, 1, left) <= 0) break;   // timed out
+        ssize_t n = recv(fd, line + got, 7 - got, 0);
+        if (n <= 0) break;
+        got += n;
+    }
+    if (got < 7 || strncmp(line, "ICY 200", 7) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
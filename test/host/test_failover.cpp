@@ -0,0 +1,90 @@
+// Failover across local stand-in relays, one of which hangs: the walk in
+// openWithinBudget() must skip past it, stay inside the connect budget and
+// rank the hung host down so the next connect goes straight to a good one.
+// Times are scaled down 10x from the device (5 s attempt, 10 s budget).
+#include <algorithm>
+#include <map>
+#include "check.h"
+#include "standin.h"
+#include "failover.h"
+
+static const uint32_t ATTEMPT_MS = 500;
+static const uint32_t BUDGET_MS  = 1000;
+
+static std::map<std::string, HostRank> ranks;
+
+struct Result { int idx; uint32_t ms; int tries; };
+
+// Same shape as connectStream(): rank, then walk within the budget
+static Result connect(const std::vector<std::string> &list, bool (*stop)(int) = nullptr) {
+    std::vector<std::string> cands = list;
+    std::stable_sort(cands.begin(), cands.end(), [](const std::string &a, const std::string &b) {
+        return ranks[a].score() < ranks[b].score();
+    });
+    int tries = 0;
+    uint32_t t0 = hostMillis();
+    int got = openWithinBudget((int)cands.size(), ATTEMPT_MS, BUDGET_MS,
+        [] { return hostMillis(); },
+        [&](int i) {
+            tries++;
+            uint32_t a = hostMillis();
+            int fd = standInOpen(cands[i], ATTEMPT_MS);
+            ranks[cands[i]].note(fd >= 0, hostMillis() - a);
+            if (fd >= 0) close(fd);
+            return fd >= 0;
+        },
+        [&] { return stop && stop(tries); });
+    Result r = { got, hostMillis() - t0, tries };
+    if (got >= 0) {   // report the index in the caller's order
+        std::string u = cands[got];
+        r.idx = -1;
+        for (size_t i = 0; i < list.size(); i++) if (list[i] == u) r.idx = (int)i;
+    }
+    return r;
+}
+
+int main() {
+    StandIn hang(StandIn::HANG), refused(StandIn::REFUSE);
+    StandIn fast(StandIn::OK), slow(StandIn::SLOW, 150);
+
+    // 1. Hung relay ranked first: one attempt timeout, then the good one
+    std::vector<std::string> list = { hang.url(), refused.url(), fast.url() };
+    Result r = connect(list);
+    printf("  hang first:   connected after %u ms, %d tries\n", r.ms, r.tries);
+    CHECK(r.idx >= 0);
+    CHECK(r.tries == 3);
+    CHECK(r.ms >= ATTEMPT_MS && r.ms < ATTEMPT_MS + 200);
+
+    // 2. The hung and refusing hosts ranked down: next connect is direct
+    r = connect(list);
+    printf("  reconnect:    connected after %u ms, %d tries\n", r.ms, r.tries);
+    CHECK(r.tries == 1);
+    CHECK(r.ms < 100);
+
+    // 3. Every relay hangs: give up inside the budget, not 4 x attempt
+    StandIn h2(StandIn::HANG), h3(StandIn::HANG), h4(StandIn::HANG);
+    r = connect({ hang.url(), h2.url(), h3.url(), h4.url() });
+    printf("  all hung:     gave up after %u ms, %d tries (budget %u)\n",
+           r.ms, r.tries, BUDGET_MS);
+    CHECK(r.idx < 0);
+    CHECK(r.tries == 2);
+    CHECK(r.ms <= BUDGET_MS + 100);
+
+    // 4. A new command cancels the walk between attempts
+    StandIn h5(StandIn::HANG), h6(StandIn::HANG);
+    r = connect({ h5.url(), h6.url() }, [](int tries) { return tries >= 1; });
+    printf("  cancelled:    stopped after %u ms, %d tries\n", r.ms, r.tries);
+    CHECK(r.idx < 0);
+    CHECK(r.tries == 1);
+
+    // 5. Two healthy relays: the lower time-to-first-byte wins the ranking
+    for (int i = 0; i < 3; i++) connect({ slow.url() });
+    for (int i = 0; i < 3; i++) connect({ fast.url() });
+    printf("  ttfb ranking: slow=%u ms fast=%u ms\n",
+           ranks[slow.url()].ttfbMs, ranks[fast.url()].ttfbMs);
+    CHECK(ranks[fast.url()].score() < ranks[slow.url()].score());
+    r = connect({ slow.url(), fast.url() });
+    CHECK(r.idx == 1 && r.tries == 1);
+
+    return checkReport("test_failover");
+}
@@ -0,0 +1,180 @@
+// Time-shift against a local stand-in Icecast relay: play live, pause
+// (the stream keeps going into the ring), resume from the pause point,
+// catch up and switch back to the socket. Every byte that reaches the
+// "decoder" must be the next byte of the stream: nothing lost or repeated
+// across the pause, the ring or the switch back to live. The tsTask side
+// is the same loop as in main.cpp over TsRing/fifoPass; playback drains
+// 50% fast here (TS_CATCHUP_PCT on the device) to keep the test short.
+// Also reports ring write throughput on the host file system.
+#include <fcntl.h>
+#include <atomic>
+#include "check.h"
+#include "standin.h"
+#include "timeshift.h"
+
+#define TS_CHUNK    2048
+#define TS_IN_SIZE  6144
+#define TS_OUT_SIZE 4096
+#define KBPS        128
+#define RATE        (KBPS * 125)   // bytes per second
+
+struct HostFile {
+    FILE *fp;
+    bool   seek(uint32_t pos)                 { return fseek(fp, pos, SEEK_SET) == 0; }
+    size_t write(const uint8_t *b, size_t n)  { return fwrite(b, 1, n, fp); }
+    size_t read(uint8_t *b, size_t n)         { return fread(b, 1, n, fp); }
+};
+
+static ByteFifo tsIn, tsOut;
+static std::atomic<bool> paused{false}, drained{false}, running{true};
+static std::atomic<uint32_t> lagBytes{0};
+
+// tsTask: the loop body from main.cpp
+static void tsLoop(TsRing<HostFile> &ring) {
+    uint8_t chunk[TS_CHUNK];
+    while (running) {
+        if (!drained && !paused && ring.stored() == 0) drained = true;
+        if (drained) {
+            while (fifoPass(tsIn, tsOut, chunk, TS_CHUNK)) {}
+        } else {
+            while (ring.store(tsIn, chunk, TS_CHUNK)) {}
+            while (!paused && ring.load(tsOut, chunk, TS_CHUNK)) {}
+        }
+        lagBytes = ring.stored() + tsIn.used() + tsOut.used();
+        usleep(2000);
+    }
+}
+
+static uint64_t verified = 0;
+static bool     inOrder  = true;
+
+static void consume(const uint8_t *d, size_t n) {
+    for (size_t i = 0; i < n; i++)
+        if (d[i] != standInByte(verified + i)) inOrder = false;
+    verified += n;
+}
+
+// Socket → tsIn, as AudioFileSourceTimeShift::pump()
+static void pump(int fd) {
+    uint8_t tmp[512];
+    for (int i = 0; i < 8; i++) {
+        uint32_t room = u32min(sizeof(tmp), tsIn.space());
+        if (room == 0) break;
+        ssize_t n = recv(fd, tmp, room, MSG_DONTWAIT);
+        if (n <= 0) break;
+        tsIn.push(tmp, n);
+    }
+}
+
+static void writeThroughput() {
+    const uint32_t cap = 8192 * 1024, total = 64u << 20;
+    for (int flush = 0; flush < 2; flush++) {
+        HostFile f = { tmpfile() };
+        TsRing<HostFile> ring;
+        ring.reset(&f, cap);
+        ByteFifo in;
+        in.alloc(TS_CHUNK);
+        uint8_t src[TS_CHUNK], chunk[TS_CHUNK];
+        for (int i = 0; i < TS_CHUNK; i++) src[i] = standInByte(i);
+        uint64_t worst = 0, t0 = hostNanos();
+        for (uint32_t done = 0; done < total; done += TS_CHUNK) {
+            uint64_t c0 = hostNanos();
+            in.push(src, TS_CHUNK);
+            ring.store(in, chunk, TS_CHUNK);
+            if (flush) fflush(f.fp);
+            uint64_t dt = hostNanos() - c0;
+            if (dt > worst) worst = dt;
+        }
+        double s = (hostNanos() - t0) / 1e9;
+        printf("  ring write%s: %.0f MB/s, worst chunk %.0f us (%.0fx the %d kbps stream)\n",
+               flush ? " + flush per chunk" : "", total / 1048576.0 / s, worst / 1e3,
+               total / s / RATE, KBPS);
+        CHECK(ring.stored() == cap);
+        in.release();
+        fclose(f.fp);
+    }
+}
+
+int main() {
+    StandIn relay(StandIn::OK, 0, KBPS);
+    int fd = standInOpen(relay.url(), 1000);
+    CHECK(fd >= 0);
+    if (fd < 0) return checkReport("test_timeshift");
+    // Skip the rest of the ICY header
+    char c, last[4] = {};
+    while (recv(fd, &c, 1, 0) == 1) {
+        memmove(last, last + 1, 3);
+        last[3] = c;
+        if (!memcmp(last, "\r\n\r\n", 4)) break;
+    }
+
+    HostFile f = { tmpfile() };
+    TsRing<HostFile> ring;
+    ring.reset(&f, 64 * 1024);
+    tsIn.alloc(TS_IN_SIZE);
+    tsOut.alloc(TS_OUT_SIZE);
+
+    uint8_t buf[1024];
+    auto playLive = [&](uint32_t ms) {
+        uint32_t t0 = hostMillis();
+        while (hostMillis() - t0 < ms) {
+            ssize_t n = recv(fd, buf, sizeof(buf), MSG_DONTWAIT);
+            if (n > 0) consume(buf, n);
+            usleep(5000);
+        }
+    };
+
+    playLive(1000);
+    uint64_t atPause = verified;
+
+    // Pause: the audio task pumps the socket into tsIn, tsTask fills the ring
+    paused = true;
+    std::thread ts([&] { tsLoop(ring); });
+    uint32_t t0 = hostMillis();
+    while (hostMillis() - t0 < 3000) { pump(fd); usleep(5000); }
+    uint32_t lagAtResume = lagBytes;
+
+    // Resume from the pause point, 1.5x until the FIFOs are empty
+    paused = false;
+    t0 = hostMillis();
+    uint64_t budget = 0;
+    bool live = false;
+    uint32_t caughtUpMs = 0;
+    uint64_t shiftedStart = verified;
+    while (!live && hostMillis() - t0 < 20000) {
+        budget += RATE * 3 / 2 / 100;   // 10 ms of 1.5x playback
+        bool d = drained;
+        if (!d) pump(fd);
+        uint32_t n = tsOut.pop(buf, (uint32_t)std::min<uint64_t>(budget, sizeof(buf)));
+        consume(buf, n);
+        budget -= n;
+        if (!n && d && tsIn.used() == 0 && tsOut.used() == 0) {
+            live = true;
+            caughtUpMs = hostMillis() - t0;
+        }
+        usleep(10000);
+    }
+    running = false;
+    ts.join();
+    uint64_t shifted = verified - shiftedStart;
+
+    playLive(1000);   // straight from the socket again
+
+    printf("  paused 3000 ms at byte %llu, lag %u B (%.1f s)\n",
+           (unsigned long long)atPause, lagAtResume, (double)lagAtResume / RATE);
+    printf("  caught up after %u ms (%llu B from the ring), %llu B verified in order\n",
+           caughtUpMs, (unsigned long long)shifted, (unsigned long long)verified);
+    CHECK(inOrder);
+    CHECK(live);
+    CHECK(lagAtResume > 2 * RATE);
+    CHECK(shifted >= lagAtResume);
+    CHECK(verified > atPause + 4 * RATE);
+
+    close(fd);
+    tsIn.release();
+    tsOut.release();
+    fclose(f.fp);
+
+    writeThroughput();
+    return checkReport("test_timeshift");
+}